@@ -5,15 +5,212 @@
 #ifndef AVLTREE_H
 #define AVLTREE_H
 
+#include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <ostream>
+#include <unordered_set>
+#include "HashIndex.h"
+#include "MappedAVLTree.h"
+#include "NodePool.h"
+#include "ThreadPool.h"
 
-class AVLTree {
+/**
+ *	Counters describing the work done by a tree since it was created, or
+ *	since its `resetStats()` was last called.
+ *
+ *	The allocation counters are always kept. The rotations, comparisons and
+ *	path lengths are only kept by trees built with `AVLTREE_STATS` defined to
+ *	a nonzero value, and are `0` otherwise.
+ */
+struct AVLTreeStats {
+
+	/** The kinds of descents whose path lengths are kept apart. */
+	enum class Operation : size_t {
+
+		/** Lookups, including `find()`, bounds, ranks, and both bounds of range scans. */
+		LOOKUP = 0,
+
+		/** Insertions, one key at a time or in a batch. */
+		INSERT = 1,
+
+		/** Removals, one key at a time or in a batch. */
+		REMOVE = 2,
+
+		/** Splits at a key, by `split()`, `removeRange()`, and the set operations. */
+		SPLIT = 3,
+	};
+
+	static constexpr size_t OPERATIONS = 4;
+
+	/** Descents comparing the search key with more nodes than this are counted as this long. */
+	static constexpr size_t MAX_PATH_LENGTH = 64;
+
+	/** Number of rebalancings by one rotation, and by two, after insertions and removals. */
+	size_t singleRotations = 0;
+	size_t doubleRotations = 0;
+
+	/**
+	 *	Number of times a search key was compared with the key of a node during
+	 *	a descent of one of the kinds above. Comparisons outside of descents are
+	 *	not counted: those that check the order of the trees given to `join()`,
+	 *	and those that sort or deduplicate the input of batches and bulk loads.
+	 */
+	size_t comparisons = 0;
+
+	/**
+	 *	Number of those comparisons that the cached key prefixes could not decide,
+	 *	so that the key bytes of the node were read. Long shared prefixes show up here.
+	 */
+	size_t longComparisons = 0;
+
+	/** Node allocations and frees, as counted by the `NodePool` of the tree. */
+	size_t nodesCreated = 0;
+	size_t nodesDestroyed = 0;
+	size_t slabAllocations = 0;
+
+	/**
+	 *	`pathLengths[op][d]` is the number of descents of the kind `op` that
+	 *	compared the search key with `d` nodes.
+	 */
+	std::array<std::array<size_t, MAX_PATH_LENGTH + 1>, OPERATIONS> pathLengths{};
+};
+
+/**
+ *	Counters of the lookup cache of the calling thread. That cache is shared
+ *	by every tree of the same type that the thread reads, so these count the
+ *	lookups of the thread in all of them.
+ */
+struct LookupCacheStats {
+
+	/** Lookups answered by the cache, and lookups that had to search the tree. */
+	size_t hits = 0;
+	size_t misses = 0;
+
+	/** Searches after a miss that started below the root, from the path of the previous search. */
+	size_t fingerStarts = 0;
+
+	double hitRate() const {
+		return (this->hits + this->misses) ? static_cast<double>(this->hits) / (this->hits + this->misses) : 0.0;
+	}
+};
+
+/** Defined in `FrozenAVLTree.h`, which must be included to call `BasicAVLTree::freeze()`. */
+template <typename Key, typename Value, typename Compare>
+class BasicFrozenAVLTree;
+
+/** Lookups by other types than the key type are only offered by transparent comparators. */
+template <typename Compare>
+concept TransparentCompare = requires {typename Compare::is_transparent;};
+
+/**
+ *	An AVL tree mapping unique keys to values, ordered by `Compare`.
+ *	Nodes are allocated from a `NodePool`, which draws its slabs from `Allocator`.
+ *
+ *	`AVLTree` is the tree of `std::string` keys and `size_t` values.
+ *
+ *	If `Compare` is transparent, like the default `std::less<>`, lookups also
+ *	accept any type that can be compared to the keys, so that `std::string_view`
+ *	or `const char *` lookups on string keys don't construct a temporary key.
+ *
+ *	A tree whose keys are hashable and ordered by `std::less` can keep a hash
+ *	index next to its nodes, which `setHashIndex()` turns on or off for each
+ *	tree. Exact-match lookups then probe the index instead of descending the
+ *	tree, while range queries and iteration still walk the tree.
+ *
+ *	Such a tree can instead turn on a lookup cache with `setLookupCache()`,
+ *	for skewed reads. Each thread then remembers the nodes that its recent
+ *	`get()` and `contains()` calls found, in a small table of its own, and
+ *	starts each search that misses the table from where its last search ended.
+ */
+template <
+	typename Key = std::string, typename Value = size_t,
+	typename Compare = std::less<>, typename Allocator = std::allocator<std::pair<const Key, Value>>
+>
+class BasicAVLTree {
 	public:
-		using KeyType = std::string;
-		using ValueType = size_t;
+		using KeyType = Key;
+		using ValueType = Value;
+
+		using key_type = Key;
+		using mapped_type = Value;
+		using key_compare = Compare;
+		using allocator_type = Allocator;
+
+		/** How a range query treats one of its two bounding keys. */
+		enum class Bound {
+
+			/** Keys equal to the bounding key are in the range. */
+			INCLUSIVE,
+
+			/** Keys equal to the bounding key are not in the range. */
+			EXCLUSIVE,
+
+			/** The range is not limited on this side, so the bounding key is ignored. */
+			UNBOUNDED,
+		};
+
+		/** What a bulk load does with pairs whose keys are equal. */
+		enum class DuplicatePolicy {
+
+			/** Nothing is loaded if any two keys are equal. */
+			REJECT,
+
+			/** Only the first of the equal keys in the input is loaded. */
+			KEEP_FIRST,
+
+			/** Only the last of the equal keys in the input is loaded. */
+			KEEP_LAST,
+		};
+
+		/**
+		 *	A key-value pair as seen through the iterators of the tree.
+		 *	The key can't be changed in place, since that would break the order of the tree.
+		 */
+		struct Entry {
+			const KeyType key;
+			ValueType value;
+		};
+
+		using value_type = Entry;
+
+		/**
+		 *	Whether the tree counts its rotations, comparisons and descents for
+		 *	`stats()`. This is set by defining `AVLTREE_STATS` to a nonzero value,
+		 *	which must be done alike for every translation unit, since it changes
+		 *	the layout of the tree. When it is not set, counting costs nothing.
+		 */
+#if defined(AVLTREE_STATS) && (AVLTREE_STATS != 0)
+		static constexpr bool KEEPS_STATS = true;
+#else
+		static constexpr bool KEEPS_STATS = false;
+#endif
+
+		/**
+		 *	Number of nodes that the lookup cache of each thread holds, which is
+		 *	set by defining `AVLTREE_LOOKUP_CACHE_SLOTS` to a power of two, alike
+		 *	for every translation unit. The cache is direct-mapped, so it should be
+		 *	a few times larger than the set of hot keys.
+		 */
+#if defined(AVLTREE_LOOKUP_CACHE_SLOTS)
+		static constexpr size_t LOOKUP_CACHE_SLOTS = AVLTREE_LOOKUP_CACHE_SLOTS;
+#else
+		static constexpr size_t LOOKUP_CACHE_SLOTS = 4096;
+#endif
+		static_assert(std::has_single_bit(LOOKUP_CACHE_SLOTS), "AVLTREE_LOOKUP_CACHE_SLOTS must be a power of two");
 
 	protected:
 
@@ -44,16 +241,68 @@ class AVLTree {
 			RIGHT = -1,
 		};
 
-		class AVLNode {
+		/**
+		 *	String keys ordered by `std::less` are compared with `std::string_view::compare`,
+		 *	which decides all three outcomes with a single comparison.
+		 */
+		static constexpr bool USES_STRING_ORDER = std::is_same_v<Key, std::string> && (
+			std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<std::string>>
+		);
+
+		/** Counters behind `stats()`, which take no space unless `KEEPS_STATS` is set. */
+		struct StatsCounters {
+			std::atomic<size_t> singleRotations{0};
+			std::atomic<size_t> doubleRotations{0};
+			std::atomic<size_t> comparisons{0};
+			std::atomic<size_t> longComparisons{0};
+			std::atomic<size_t> pathLengths[AVLTreeStats::OPERATIONS][AVLTreeStats::MAX_PATH_LENGTH + 1] = {};
+		};
+		struct NoStats {};
+
+		/** Binary snapshots hold keys in the order of their bytes, and values as their bytes. */
+		static constexpr bool HAS_SNAPSHOTS =
+			USES_STRING_ORDER && std::is_trivially_copyable_v<Value> && alignof(Value) <= 8;
+
+		/**
+		 *	The hash index relies on keys that `Compare` finds equivalent being
+		 *	equal, so that they hash alike, which holds for `std::less`.
+		 */
+		static constexpr bool HAS_HASH_INDEX =
+			(std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<Key>>) &&
+			requires (const Key &key) {{std::hash<Key>{}(key)} -> std::convertible_to<size_t>;};
+
+		/** Takes no space in trees whose keys can't be indexed. */
+		struct NoIndex {
+			NoIndex() = default;
+			template <typename A>
+			explicit NoIndex(const A &) {}
+		};
+
+		/** Takes no space in the nodes of trees whose keys have no cached prefix. */
+		struct NoPrefix {};
+
+		/**
+		 *	The first `PREFIX_BYTES` bytes of a string key, packed big-endian, so
+		 *	that comparing two prefixes as integers orders them like their bytes.
+		 */
+		using KeyPrefix = std::conditional_t<USES_STRING_ORDER, uint64_t, NoPrefix>;
+		static constexpr size_t PREFIX_BYTES = 8;
+
+		class AVLNode : public Entry {
 			public:
-				KeyType key;
-				ValueType value;
+				[[no_unique_address]] KeyPrefix prefix;
+
 				size_t height;
 
+				/** Number of nodes in the subtree rooted at this node, including itself. */
+				size_t count;
+
 				AVLNode *left;
 				AVLNode *right;
 
-				AVLNode(const KeyType &key, const ValueType &value);
+				/** The key is built from `key`, and the value from the remaining arguments. */
+				template <typename K, typename... Args>
+				AVLNode(K &&key, Args &&...args);
 
 				/** Must return `0`, `1`, or `2`. */
 				size_t numChildren() const;
@@ -64,64 +313,605 @@ class AVLTree {
 				/** Number of hops to deepest leaf node. */
 				size_t getHeight() const;
 
+				/** Number of nodes in the subtree rooted at this node. */
+				size_t getCount() const;
+
+				void update();
+
 				/** The difference between the heights of this node's children. */
 				ssize_t getBalance() const;
 
-				void rotateLeft(const AVLTree::Direction &childDir);
-				void rotateRight(const AVLTree::Direction &childDir);
+				void rotateLeft(const Direction &childDir);
+				void rotateRight(const Direction &childDir);
+		};
+
+		/**
+		 *	The nodes on the way from the root down to one node, with the root first.
+		 *	The height of an AVL tree is at most about `1.44 * log2(n)`, so `MAX_DEPTH`
+		 *	nodes cover any tree that can fit in memory.
+		 */
+		class Path {
+			public:
+				static constexpr size_t MAX_DEPTH = 64;
+
+				Path() : depth(0) {}
+				Path(const Path &other) : depth(other.depth) {this->copyFrom(other);}
+				Path & operator=(const Path &other) {
+					this->depth = other.depth;
+					this->copyFrom(other);
+					return *this;
+				}
+
+				void push(AVLNode *node) {this->nodes[this->depth++] = node;}
+				void pop() {--this->depth;}
+				void clear() {this->depth = 0;}
+				bool empty() const {return this->depth == 0;}
+				size_t size() const {return this->depth;}
+
+				/** The node at the end of the path, or `nullptr` if the path is empty. */
+				AVLNode * top() const {return this->depth ? this->nodes[this->depth - 1] : nullptr;}
+
+				/** The parent of the node at the end of the path, if it has one. */
+				AVLNode * parent() const {return (this->depth > 1) ? this->nodes[this->depth - 2] : nullptr;}
+
+				/** Shortens the path to its first `newDepth` nodes. */
+				void truncate(size_t newDepth) {this->depth = newDepth;}
+
+				AVLNode * operator[](size_t i) const {return this->nodes[i];}
+
+				/** Puts another node in place of the node at position `i`. */
+				void replace(size_t i, AVLNode *node) {this->nodes[i] = node;}
+
+			private:
+				AVLNode *nodes[MAX_DEPTH];
+				size_t depth;
+
+				/** Only the nodes that are on the path are copied. */
+				void copyFrom(const Path &other) {
+					for (size_t i = 0; i < other.depth; ++i) {this->nodes[i] = other.nodes[i];}
+				}
+		};
+
+		using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<AVLNode>;
+		using Pool = NodePool<AVLNode, NodeAllocator>;
+
+		using IndexAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<AVLNode *>;
+		using Index = std::conditional_t<HAS_HASH_INDEX, HashIndex<AVLNode, IndexAllocator>, NoIndex>;
+
+		/** A node that the lookup cache holds, found by a key with this hash in the tree stamped `stamp`. */
+		struct CachedNode {
+			uint64_t stamp;
+			size_t hash;
+			AVLNode *node;
+		};
+
+		/**
+		 *	The lookup cache of one thread. Next to the cached nodes, it keeps the
+		 *	path of the last search that missed them, which is the finger the next
+		 *	search starts from. It is all zeros at first, so it needs no constructor.
+		 */
+		struct LookupCache {
+			CachedNode nodes[LOOKUP_CACHE_SLOTS];
+			uint64_t fingerStamp;
+			size_t fingerDepth;
+			AVLNode *finger[Path::MAX_DEPTH];
+			LookupCacheStats stats;
 		};
 
 	public:
-		AVLTree();
-		AVLTree(const AVLTree &other);
-		~AVLTree();
-		void operator=(const AVLTree &other);
+
+		/**
+		 *	Bidirectional iterator over the key-value pairs of the tree, in ascending
+		 *	order of the keys.
+		 *
+		 *	The iterator keeps the path from the root to its node, so each step is
+		 *	`O(1)` amortized and nothing is allocated. Any insertion or removal may
+		 *	rotate the nodes on that path, so it invalidates every iterator.
+		 */
+		template <bool IsConst>
+		class BasicIterator {
+			public:
+				using iterator_category = std::bidirectional_iterator_tag;
+				using iterator_concept = std::bidirectional_iterator_tag;
+				using value_type = Entry;
+				using difference_type = std::ptrdiff_t;
+				using reference = std::conditional_t<IsConst, const Entry &, Entry &>;
+				using pointer = std::conditional_t<IsConst, const Entry *, Entry *>;
+
+				BasicIterator() : root(nullptr) {}
+
+				/** A mutable iterator can be converted to a const iterator. */
+				template <bool OtherConst> requires (IsConst && !OtherConst)
+				BasicIterator(const BasicIterator<OtherConst> &other) : root(other.root), path(other.path) {}
+
+				reference operator*() const {return *this->path.top();}
+				pointer operator->() const {return this->path.top();}
+
+				BasicIterator & operator++() {
+					BasicAVLTree::next(this->path);
+					return *this;
+				}
+
+				BasicIterator operator++(int) {
+					BasicIterator old = *this;
+					BasicAVLTree::next(this->path);
+					return old;
+				}
+
+				/** Decrementing the end iterator moves to the largest key. */
+				BasicIterator & operator--() {
+					BasicAVLTree::prev(this->root, this->path);
+					return *this;
+				}
+
+				BasicIterator operator--(int) {
+					BasicIterator old = *this;
+					BasicAVLTree::prev(this->root, this->path);
+					return old;
+				}
+
+				template <bool OtherConst>
+				bool operator==(const BasicIterator<OtherConst> &other) const {
+					return this->path.top() == other.path.top();
+				}
+
+			private:
+				friend class BasicAVLTree;
+				template <bool> friend class BasicIterator;
+
+				AVLNode *root;
+				Path path;
+
+				BasicIterator(AVLNode *root, const Path &path) : root(root), path(path) {}
+		};
+
+		using iterator = BasicIterator<false>;
+		using const_iterator = BasicIterator<true>;
+
+		/**
+		 *	Subtrees of at most this many nodes are handled by a single thread in
+		 *	the parallel operations, so that forking never costs more than the work
+		 *	it hands over.
+		 */
+		static constexpr size_t PARALLEL_CUTOFF = 4096;
+
+		explicit BasicAVLTree(const Compare &comp = Compare(), const Allocator &alloc = Allocator());
+		BasicAVLTree(const BasicAVLTree &other);
+		BasicAVLTree(const BasicAVLTree &other, ThreadPool &pool, size_t cutoff = PARALLEL_CUTOFF);
+		BasicAVLTree(BasicAVLTree &&other) noexcept;
+
+		template <std::input_iterator It, std::sentinel_for<It> S>
+		BasicAVLTree(
+			It first, S last, DuplicatePolicy policy = DuplicatePolicy::KEEP_FIRST,
+			const Compare &comp = Compare(), const Allocator &alloc = Allocator()
+		);
+
+		~BasicAVLTree();
+		BasicAVLTree & operator=(const BasicAVLTree &other);
+		BasicAVLTree & operator=(BasicAVLTree &&other) noexcept;
 
 		bool insert(const KeyType &key, ValueType value);
+		bool insert(KeyType &&key, ValueType value);
 		bool remove(const KeyType &key);
+
+		template <std::input_iterator It, std::sentinel_for<It> S>
+		bool bulkLoad(It first, S last, DuplicatePolicy policy = DuplicatePolicy::REJECT);
+		template <std::input_iterator It, std::sentinel_for<It> S>
+		bool bulkLoad(
+			It first, S last, ThreadPool &pool,
+			DuplicatePolicy policy = DuplicatePolicy::REJECT, size_t cutoff = PARALLEL_CUTOFF
+		);
+
+		void clear();
+		void clear(ThreadPool &pool, size_t cutoff = PARALLEL_CUTOFF);
+
+		template <std::input_iterator It, std::sentinel_for<It> S>
+		size_t insertBatch(It first, S last);
+		template <std::input_iterator It, std::sentinel_for<It> S>
+		size_t removeBatch(It first, S last);
+
+		size_t removeRange(
+			const KeyType &low, const KeyType &high,
+			Bound lowBound = Bound::INCLUSIVE, Bound highBound = Bound::INCLUSIVE
+		);
+
+		BasicAVLTree split(const KeyType &key);
+		bool join(KeyType key, ValueType value, BasicAVLTree &&right);
+		bool join(BasicAVLTree &&right);
+
+		size_t unionWith(const BasicAVLTree &other);
+		size_t unionWith(BasicAVLTree &&other);
+		size_t unionWith(BasicAVLTree &&other, ThreadPool &pool, size_t cutoff = PARALLEL_CUTOFF);
+		size_t intersect(const BasicAVLTree &other);
+		size_t difference(const BasicAVLTree &other);
+
+		template <typename KeyArg, typename... Args>
+		std::pair<iterator, bool> emplace(KeyArg &&key, Args &&...args);
+
+		template <typename... Args>
+		std::pair<iterator, bool> try_emplace(const KeyType &key, Args &&...args);
+		template <typename... Args>
+		std::pair<iterator, bool> try_emplace(KeyType &&key, Args &&...args);
+
+		template <typename M>
+		std::pair<iterator, bool> insert_or_assign(const KeyType &key, M &&value);
+		template <typename M>
+		std::pair<iterator, bool> insert_or_assign(KeyType &&key, M &&value);
+
 		bool contains(const KeyType &key) const;
+		template <typename K> requires TransparentCompare<Compare>
+		bool contains(const K &key) const;
 
 		std::optional<ValueType> get(const KeyType &key) const;
+		template <typename K> requires TransparentCompare<Compare>
+		std::optional<ValueType> get(const K &key) const;
+
+		bool getBatch(std::span<const KeyType> keys, std::span<std::optional<ValueType>> values, bool sortFirst = false) const;
+		bool containsBatch(std::span<const KeyType> keys, std::span<bool> found, bool sortFirst = false) const;
+
 		ValueType & operator[](const KeyType &key);
 
+		iterator begin();
+		iterator end();
+		const_iterator begin() const;
+		const_iterator end() const;
+		const_iterator cbegin() const;
+		const_iterator cend() const;
+
+		iterator find(const KeyType &key);
+		const_iterator find(const KeyType &key) const;
+		template <typename K> requires TransparentCompare<Compare>
+		iterator find(const K &key);
+		template <typename K> requires TransparentCompare<Compare>
+		const_iterator find(const K &key) const;
+
+		iterator lower_bound(const KeyType &key);
+		const_iterator lower_bound(const KeyType &key) const;
+		template <typename K> requires TransparentCompare<Compare>
+		iterator lower_bound(const K &key);
+		template <typename K> requires TransparentCompare<Compare>
+		const_iterator lower_bound(const K &key) const;
+
+		iterator upper_bound(const KeyType &key);
+		const_iterator upper_bound(const KeyType &key) const;
+		template <typename K> requires TransparentCompare<Compare>
+		iterator upper_bound(const K &key);
+		template <typename K> requires TransparentCompare<Compare>
+		const_iterator upper_bound(const K &key) const;
+
 		std::vector<KeyType> keys() const;
 		std::vector<ValueType> findRange(const KeyType &low, const KeyType &high) const;
 
+		template <typename OutputIt>
+		OutputIt findRange(
+			const KeyType &low, const KeyType &high, OutputIt out,
+			Bound lowBound = Bound::INCLUSIVE, Bound highBound = Bound::INCLUSIVE, bool unique = false
+		) const;
+
+		template <typename Visitor>
+		void visitRange(
+			const KeyType &low, const KeyType &high, Visitor &&visit,
+			Bound lowBound = Bound::INCLUSIVE, Bound highBound = Bound::INCLUSIVE
+		) const;
+
+		size_t rank(const KeyType &key) const;
+		std::optional<KeyType> select(size_t k) const;
+		size_t countRange(
+			const KeyType &low, const KeyType &high,
+			Bound lowBound = Bound::INCLUSIVE, Bound highBound = Bound::INCLUSIVE
+		) const;
+		std::vector<KeyType> keysPage(size_t offset, size_t limit) const;
+
 		size_t size() const;
 		size_t getHeight() const;
 
-		friend std::ostream & operator<<(std::ostream &os, const AVLTree &avlTree);
+		const NodePoolStats & allocationStats() const;
+		AVLTreeStats stats() const;
+		void resetStats();
+
+		void setHashIndex(bool enabled) requires HAS_HASH_INDEX;
+		bool hasHashIndex() const;
+		size_t hashIndexMemory() const;
+
+		void setLookupCache(bool enabled) requires HAS_HASH_INDEX;
+		bool hasLookupCache() const;
+		static LookupCacheStats lookupCacheStats();
+		static void resetLookupCacheStats();
+
+		Compare key_comp() const;
+		Allocator get_allocator() const;
+
+		BasicFrozenAVLTree<Key, Value, Compare> freeze() const;
+
+		bool save(const std::string &path) const requires HAS_SNAPSHOTS;
+		bool load(const std::string &path) requires HAS_SNAPSHOTS;
+
+		/**
+		 *	Prints every node in the tree that resembles the tree's structure.
+		 */
+		friend std::ostream & operator<<(std::ostream &os, const BasicAVLTree &avlTree) {
+			BasicAVLTree::printDepth(os, avlTree.root, 0);
+			return os;
+		}
 
 	private:
 		AVLNode *root;
 		size_t length;
+		[[no_unique_address]] Compare comp;
+		Pool nodes;
 
-		/* Recursive overloads for the methods declared above. */
+		/** Holds every node of the tree while the hash index is on, and no slots while it is off. */
+		[[no_unique_address]] Index index;
+
+		/**
+		 *	Tells the nodes of this tree apart in the lookup caches of all threads,
+		 *	or is `0` while the tree has no cache. No two trees share a stamp, and a
+		 *	tree takes a new one when it is cleared, split, joined or combined with
+		 *	another tree, which drops every cached pointer to its nodes at once.
+		 */
+		uint64_t cacheStamp;
+
+		/**
+		 *	The address of the only lookup cache that has cached nodes under the
+		 *	current stamp, `0` if none has, or `SHARED_CACHE` once a second thread
+		 *	has. Removing a single node only clears its slot in an own cache.
+		 */
+		mutable uintptr_t cacheOwner;
+
+		/** Updated by lookups as well, with relaxed atomic increments, so that concurrent readers may share the tree. */
+		[[no_unique_address]] mutable std::conditional_t<KEEPS_STATS, StatsCounters, NoStats> counters;
+
+		/**
+		 *	Three-way comparison of a key with another key, or with any type the
+		 *	transparent comparator accepts.
+		 *
+		 *	@return A negative integer if `a < b`; `0` if `a == b`; or a positive integer if `a > b`.
+		 */
+		template <typename A, typename B>
+		int compareKeys(const A &a, const B &b) const {
+			if constexpr (
+				USES_STRING_ORDER &&
+				std::is_convertible_v<const A &, std::string_view> &&
+				std::is_convertible_v<const B &, std::string_view>
+			) {
+				return std::string_view(a).compare(std::string_view(b));
+			} else {
+				return this->comp(a, b) ? -1 : (this->comp(b, a) ? 1 : 0);
+			}
+		}
+
+		/**
+		 *	A search key prepared once per operation, which is compared with the
+		 *	nodes on the way down.
+		 *
+		 *	For string keys, most levels are decided by comparing the cached key
+		 *	prefixes as integers. On a tie, the comparison skips the bytes that the
+		 *	search key is known to share with the node. Those are the bytes it
+		 *	shares with both the closest smaller and the closest greater key seen
+		 *	so far, since every key in between starts with them as well.
+		 */
+		template <typename K>
+		class Probe {
+			public:
+				Probe(const BasicAVLTree &tree, const K &key, AVLTreeStats::Operation operation = AVLTreeStats::Operation::LOOKUP);
+				~Probe();
+
+				Probe(const Probe &) = delete;
+				Probe & operator=(const Probe &) = delete;
+
+				/** Three-way comparison of the search key with the key of `node`. */
+				int compareTo(const AVLNode *node);
+
+			private:
+				static constexpr bool PREFIXED =
+					USES_STRING_ORDER && std::is_convertible_v<const K &, std::string_view>;
+
+				const BasicAVLTree &tree;
+				const K &key;
+				std::string_view view;
+				uint64_t prefix;
+
+				/** Leading bytes shared with the closest smaller and greater keys seen so far. */
+				size_t lowMatch;
+				size_t highMatch;
+
+				/** Counts of this descent, which are added to the tree's counters once it ends. */
+				AVLTreeStats::Operation operation;
+				size_t compared;
+				size_t longCompared;
+		};
+
+		static uint64_t packPrefix(std::string_view key);
+		static size_t matchLength(const char *a, const char *b, size_t n);
+
+		/* Helper methods for the hash index. */
+
+		/** Keys of these types hash like the equal keys of the tree, so they can be looked up in the index. */
+		template <typename K>
+		static constexpr bool HASHES_LIKE_KEY =
+			std::is_same_v<K, Key> || (USES_STRING_ORDER && std::is_convertible_v<const K &, std::string_view>);
+
+		template <typename K>
+		static size_t hashOf(const K &key);
+
+		template <typename... Args>
+		AVLNode * createNode(Args &&...args);
+		void destroyNode(AVLNode *node);
+
+		void rebuildIndex(bool enabled);
+		void indexNodes(AVLNode *current);
+		void unindexNodes(const AVLNode *current);
 
-		bool insert(AVLNode *current, const KeyType &key, ValueType &value);
-		bool contains(const AVLNode *current, const KeyType &key) const;
+		/* Helper methods for the lookup cache. */
 
-		std::optional<ValueType> get(const AVLNode *current, const KeyType &key) const;
-		ValueType & getValue(AVLNode *current, const KeyType &key);
+		static constexpr uintptr_t SHARED_CACHE = 1;
+
+		static LookupCache & lookupCache();
+		static uint64_t newCacheStamp();
+		void renewCacheStamp();
+		void uncacheNode(const AVLNode *node);
+		void claimCache(const LookupCache &cache) const;
+
+		template <typename K>
+		AVLNode * findCached(const K &key) const;
+		template <typename K>
+		AVLNode * fingerSearch(LookupCache &cache, const K &key) const;
+
+		/** Iterative descent shared by the point lookups. */
+		template <typename K>
+		AVLNode * findNode(const K &key) const;
+
+		/**
+		 *	Number of descents a batch lookup advances in lock-step. Enough to keep
+		 *	several cache misses in flight, while every probe stays in registers or L1.
+		 */
+		static constexpr size_t BATCH_LANES = 16;
+
+		template <typename Found>
+		void findBatch(std::span<const KeyType> keys, bool sortFirst, Found &&found) const;
+
+		/* Recursive overloads for the methods declared above. */
 
 		void grabKey(std::vector<KeyType> &keyList, const AVLNode *current) const;
-		void grabValue(std::vector<ValueType> &valueList, const AVLNode *current, const KeyType &low, const KeyType &high) const;
+		void grabKey(std::vector<KeyType> &keyList, const AVLNode *current, size_t offset, size_t limit) const;
+
+		size_t countBelow(const KeyType &key, bool inclusive) const;
+
+		template <typename Visitor>
+		void visitRange(
+			const AVLNode *current, Probe<KeyType> *low, Probe<KeyType> *high,
+			Bound lowBound, Bound highBound, Visitor &visit
+		) const;
 
 		void insert(AVLNode *&current, const AVLNode *other);
-		void remove(AVLNode *&current);
 
-		/* Helper methods for remove. */
+		void release();
+		void destroy(AVLNode *current);
+
+		/* Helper methods for the parallel operations, where each thread creates nodes in a pool of its own. */
 
-		/** This overloaded remove will do the recursion to remove the node. */
-		bool remove(AVLNode *&current, KeyType key);
+		static AVLNode * copyNodes(Pool &into, const AVLNode *other);
+		static AVLNode * copyParallel(Pool &into, const AVLNode *other, ThreadPool &pool, size_t cutoff);
+
+		template <typename It, typename S>
+		bool loadSortedParallel(It first, const S &last, DuplicatePolicy policy, ThreadPool &pool, size_t cutoff);
+		template <typename It>
+		static AVLNode * buildPicked(Pool &into, const It *picks, size_t n);
+		template <typename It>
+		static AVLNode * buildParallel(Pool &into, const It *picks, size_t n, ThreadPool &pool, size_t cutoff);
+
+		void destroyParallel(AVLNode *current, ThreadPool &pool, size_t cutoff);
+
+		AVLNode * unionParallel(
+			AVLNode *mine, AVLNode *theirs, std::vector<AVLNode *> &replaced, ThreadPool &pool, size_t cutoff
+		) const;
+
+		/* Helper methods for insertion. */
+
+		template <typename K, typename... Args>
+		std::pair<AVLNode *, bool> insertUnique(Path *found, K &&key, Args &&...args);
+		Path pathAfterInsert(const Path &path, size_t unrotated, AVLNode *node) const;
+
+		/* Helper methods for bulk loading. */
+
+		template <typename E>
+		static decltype(auto) keyOf(E &&entry);
+		template <typename E>
+		static decltype(auto) valueOf(E &&entry);
+
+		/** Length of a sorted sequence, and the number of distinct keys in it. */
+		struct SortedRun {
+			size_t length;
+			size_t distinct;
+		};
+
+		template <typename It, typename S>
+		std::vector<std::pair<KeyType, ValueType>> sortedBuffer(It first, const S &last) const;
+		template <typename It, typename S>
+		std::optional<SortedRun> scanSorted(It first, const S &last) const;
+		template <typename It, typename S>
+		bool loadSorted(It first, const S &last, const SortedRun &run, DuplicatePolicy policy);
+		template <typename It, typename S>
+		AVLNode * buildBalanced(It &it, const S &last, size_t n, DuplicatePolicy policy);
+
+		/* Helper methods for batched insertions and removals. */
+
+		/**
+		 *	A batch is merged into the tree by rebuilding it once the batch holds
+		 *	at least `1 / REBUILD_RATIO` as many keys as the tree. Smaller batches
+		 *	are faster to insert one key at a time from the finger, since a
+		 *	rebuild visits every node of the tree.
+		 */
+		static constexpr size_t REBUILD_RATIO = 2;
+
+		template <typename It, typename S>
+		size_t insertSorted(It first, const S &last, size_t count);
+		template <typename It, typename S>
+		size_t removeSorted(It first, const S &last, size_t count);
+
+		template <typename K>
+		AVLNode ** fingerSlot(Path &finger, const K &key);
+
+		static void collectNodes(std::vector<AVLNode *> &nodeList, AVLNode *current);
+		static AVLNode * linkBalanced(AVLNode *const *nodeList, size_t n);
+
+		/* Helper methods for splitting and joining, which work on subtrees and return their new roots. */
+
+		static ssize_t heightOf(const AVLNode *node);
+		static size_t countOf(const AVLNode *node);
+
+		static AVLNode * joinNodes(AVLNode *left, AVLNode *pivot, AVLNode *right);
+		static AVLNode * joinNodes(AVLNode *left, AVLNode *right);
+		static AVLNode * detachMin(AVLNode *node, AVLNode *&min);
+
+		template <typename K>
+		AVLNode * splitNodes(AVLNode *node, const K &key, AVLNode *&less, AVLNode *&greater) const;
+		template <typename K>
+		AVLNode * splitNodes(AVLNode *node, Probe<K> &probe, AVLNode *&less, AVLNode *&greater) const;
+
+		AVLNode * unionNodes(AVLNode *mine, AVLNode *theirs);
+		AVLNode * intersectNodes(AVLNode *mine, const AVLNode *theirs);
+		AVLNode * differenceNodes(AVLNode *mine, const AVLNode *theirs);
+
+		AVLNode * adoptNodes(BasicAVLTree &other);
+		void discard(AVLNode *current);
+
+		/* Helper methods for remove. */
 
 		/** `removeNode` contains the logic for actually removing a node based on the number of children. */
-		bool removeNode(AVLNode *&current);
+		bool removeNode(AVLNode *&current, Path &path);
+
+		/* Helper methods for rebalancing. */
+
+		AVLNode *& slotOf(const Path &path, size_t i);
+		size_t retrace(const Path &path, ssize_t countDelta);
+		static size_t rebalance(AVLNode *&node);
+		void countRotations(size_t rotations);
+		void countDescent(AVLTreeStats::Operation operation, size_t compared, size_t longCompared) const;
+
+		/* Helper methods for iterators. */
+
+		static void descendMin(Path &path, AVLNode *current);
+		static void descendMax(Path &path, AVLNode *current);
+		static void next(Path &path);
+		static void prev(AVLNode *root, Path &path);
+
+		template <typename K>
+		Path pathTo(const K &key) const;
+		template <typename K>
+		Path findPath(const K &key) const;
+		template <typename K>
+		Path pathToBound(const K &key, bool upper) const;
 
 		static void printDepth(std::ostream &os, const AVLNode *node, const size_t depth);
-		friend std::ostream & operator<<(std::ostream &os, const AVLNode *node);
 
-		void balanceNode(AVLNode *node, const Direction &childDir);
+		/**
+		 *	Prints an individual node represented by `{<key>: <value>}`.
+		 */
+		friend std::ostream & operator<<(std::ostream &os, const AVLNode *node) {
+			os << "{" << node->key << ": " << node->value << "}";
+			return os;
+		}
 
 		/**
 		 *	@brief Compare a number (denoted as height balance) to a direction that
@@ -139,8 +929,15 @@ class AVLTree {
 			return x - static_cast<ssize_t>(y);
 		}
 
-		void rotateLeft();
-		void rotateRight();
+		static void rotateLeft(AVLNode *&node);
+		static void rotateRight(AVLNode *&node);
 };
 
+#include "AVLTree.tpp"
+
+/** The tree of `std::string` keys and `size_t` values, which is instantiated once in `AVLTree.cpp`. */
+using AVLTree = BasicAVLTree<>;
+
+extern template class BasicAVLTree<>;
+
 #endif // AVLTREE_H
@@ -0,0 +1,3067 @@
+/**
+ *	AVLTree.tpp
+ *
+ *	Contains all method definitions of the class template declared in
+ *	`AVLTree.h`, which includes this file.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <tuple>
+#include <type_traits>
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode::numChildren() const {
+	size_t count = 0;
+	if (this->left) {++count;}
+	if (this->right) {++count;}
+	return count;
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode::isLeaf() const {
+	return this->numChildren() == 0;
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode::getHeight() const {
+	size_t lh = this->left ? this->left->height : -1;
+	size_t rh = this->right ? this->right->height : -1;
+	return std::max(lh + 1, rh + 1);
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode::getCount() const {
+	size_t lc = this->left ? this->left->count : 0;
+	size_t rc = this->right ? this->right->count : 0;
+	return lc + rc + 1;
+}
+
+/**
+ *	Recalculates the height and the subtree size of this node from its children,
+ *	which must already be up to date.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode::update() {
+	this->height = this->getHeight();
+	this->count = this->getCount();
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+ssize_t BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode::getBalance() const {
+	ssize_t lh = this->left ? this->left->height : -1;
+	ssize_t rh = this->right ? this->right->height : -1;
+	return lh - rh;
+}
+
+/**
+ *	Unlinks the node at `current` and destroys it. The `path` holds every
+ *	ancestor of that node, and it is walked back up to rebalance the tree.
+ *	Afterwards, the `path` is shortened to the nodes that kept their place.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::removeNode(AVLNode *&current, Path &path) {
+	if (!current) {
+		return false;
+	}
+
+	AVLNode *toDelete = current;
+	switch (current->numChildren()) {
+		/** Case 1: We can delete the node. */ 
+		case 0: {
+			current = nullptr;
+			break;
+		}
+
+		/** Case 2: Replace current with its only child. */
+		case 1: {
+			if (current->right) {
+				current = current->right;
+			} else {
+				current = current->left;
+			}
+			break;
+		}
+
+		/** Case 3: We have two children.
+		 *	Detach the smallest node in the right subtree on the same descent,
+		 *	then that node takes the place of this one. No key or value is copied. */
+		case 2: {
+			size_t removedDepth = path.size();
+			path.push(toDelete);
+
+			AVLNode **minSlot = &toDelete->right;
+			while ((*minSlot)->left) {
+				path.push(*minSlot);
+				minSlot = &(*minSlot)->left;
+			}
+
+			AVLNode *successor = *minSlot;
+			*minSlot = successor->right;
+			successor->left = toDelete->left;
+			successor->right = toDelete->right;
+
+			/**	The successor inherits the height and size of the removed node, so
+			 *	that retracing can tell whether the subtree at this position shrank,
+			 *	or adjust its size if retracing stops below it. */
+			successor->height = toDelete->height;
+			successor->count = toDelete->count;
+			current = successor;
+			path.replace(removedDepth, successor);
+			break;
+		}
+	}
+
+	this->destroyNode(toDelete);
+	path.truncate(this->retrace(path, -1));
+	return true;
+}
+
+/**
+ *	If `key` exists in the tree, that key-value pair is removed.
+ *	This returns `true` if that pair is successfully removed.
+ *	Otherwise, the `key` doesn't exist in the tree, then the
+ *	tree won't be modified, and this returns `false`.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::remove(const KeyType &key) {
+	Path path;
+	Probe<KeyType> probe(*this, key, AVLTreeStats::Operation::REMOVE);
+	AVLNode **slot = &this->root;
+	while (*slot) {
+		int cmp = probe.compareTo(*slot);
+		if (cmp == 0) {
+			break;
+		}
+		path.push(*slot);
+		slot = (cmp < 0) ? &(*slot)->left : &(*slot)->right;
+	}
+
+	bool nodeRemoved = this->removeNode(*slot, path);
+	if (nodeRemoved) {--this->length;}
+	return nodeRemoved;
+}
+
+/**
+ *	Returns the pointer that links the node at position `i` of the path to
+ *	its parent, or the root pointer for the first node.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode *& BasicAVLTree<Key, Value, Compare, Allocator>::slotOf(const Path &path, size_t i) {
+	if (i == 0) {
+		return this->root;
+	}
+	AVLNode *parent = path[i - 1];
+	return (parent->left == path[i]) ? parent->left : parent->right;
+}
+
+/**
+ *	After a node was linked below or unlinked from the last node of the `path`,
+ *	walks back up the path and rebalances every node on it.
+ *
+ *	Once a subtree keeps the height it had before the change, no node above
+ *	it can become unbalanced, so the remaining ancestors only have their
+ *	subtree sizes adjusted by `countDelta`.
+ *
+ *	@return The number of leading nodes of the `path` that were not rotated,
+ *	which are still linked to each other as the path describes.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::retrace(const Path &path, ssize_t countDelta) {
+	size_t i = path.size();
+	while (i > 0) {
+		--i;
+		AVLNode *&slot = this->slotOf(path, i);
+		size_t oldHeight = slot->height;
+		this->countRotations(BasicAVLTree::rebalance(slot));
+		if (slot->height == oldHeight) {
+			break;
+		}
+	}
+
+	size_t unrotated = i;
+	while (i > 0) {
+		--i;
+		path[i]->count += countDelta;
+	}
+	return unrotated;
+}
+
+/**
+ *	Recalculates the height of the `node`, whose children are balanced.
+ *	If the absolute value of its height balance became greater than 1, it is
+ *	rotated so that the pointer holds a balanced subtree.
+ *
+ *	If the taller child leans the other way, that child is rotated first,
+ *	which makes a double rotation.
+ *
+ *	@return The number of rotations made, which is `0`, `1`, or `2`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::rebalance(AVLNode *&node) {
+	node->update();
+
+	if (node->getBalance() > Direction::LEFT) {
+		bool inner = node->left->getBalance() < Direction::NONE;
+		if (inner) {
+			node->rotateLeft(Direction::LEFT);
+		}
+		BasicAVLTree::rotateRight(node);
+		return inner ? 2 : 1;
+	} else if (node->getBalance() < Direction::RIGHT) {
+		bool inner = node->right->getBalance() > Direction::NONE;
+		if (inner) {
+			node->rotateRight(Direction::RIGHT);
+		}
+		BasicAVLTree::rotateLeft(node);
+		return inner ? 2 : 1;
+	}
+	return 0;
+}
+
+/**
+ *	`this` node is the parent node.
+ *	One of this node's children specified by a direction
+ *	is rotated to the left.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode::rotateLeft(const BasicAVLTree::Direction &childDir) {
+	switch (childDir) {
+		case Direction::LEFT: {
+			BasicAVLTree::rotateLeft(this->left);
+			return;
+		} case Direction::RIGHT: {
+			BasicAVLTree::rotateLeft(this->right);
+			return;
+		} default: {return;}
+	}
+}
+
+/**
+ *	Rotate the node held by this pointer to the left.
+ *	The two nodes that moved have their heights and subtree sizes updated.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::rotateLeft(AVLNode *&node) {
+	AVLNode *temp = node;
+	node = temp->right;
+	temp->right = node->left;
+	node->left = temp;
+
+	temp->update();
+	node->update();
+}
+
+/**
+ *	`this` node is the parent node.
+ *	One of this node's children specified by a direction
+ *	is rotated to the right.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode::rotateRight(const BasicAVLTree::Direction &childDir) {
+	switch (childDir) {
+		case Direction::LEFT: {
+			BasicAVLTree::rotateRight(this->left);
+			return;
+		} case Direction::RIGHT: {
+			BasicAVLTree::rotateRight(this->right);
+			return;
+		} default: {return;}
+	}
+}
+
+/**
+ *	Rotate the node held by this pointer to the right.
+ *	The two nodes that moved have their heights and subtree sizes updated.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::rotateRight(AVLNode *&node) {
+	AVLNode *temp = node;
+	node = temp->left;
+	temp->left = node->right;
+	node->right = temp;
+
+	temp->update();
+	node->update();
+}
+
+/** Creates an empty AVL tree. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+BasicAVLTree<Key, Value, Compare, Allocator>::BasicAVLTree(const Compare &comp, const Allocator &alloc) :
+	root(nullptr), length(0), comp(comp), nodes(NodeAllocator(alloc)), index(IndexAllocator(alloc)), cacheStamp(0), cacheOwner(0) {}
+
+/**
+ *	Create a copy of another AVL tree.
+ *
+ *	Because a tree has pointers to other nodes, given each node must be
+ *	independent from each other, copying another AVL tree requires a deep
+ *	copy.
+ *
+ *	This copy traverses all the nodes in the `other` tree using pre-order
+ *	traversal, and creates new nodes based on the key-value pairs of the
+ *	`other` tree. If the `other` tree has a hash index or a lookup cache, so
+ *	does the copy, for its own nodes.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+BasicAVLTree<Key, Value, Compare, Allocator>::BasicAVLTree(const BasicAVLTree &other) :
+	root(nullptr), comp(other.comp), nodes(other.nodes.get_allocator()), index(IndexAllocator(other.nodes.get_allocator())),
+	cacheStamp(other.cacheStamp ? BasicAVLTree::newCacheStamp() : 0), cacheOwner(0) {
+	this->length = other.length;
+	this->insert(this->root, other.root);
+	this->rebuildIndex(other.hasHashIndex());
+}
+
+/**
+ *	Same as the copy constructor, but the two subtrees of every node with more
+ *	than `cutoff` nodes below it are copied in parallel on the threads of `pool`.
+ *	Each thread creates its nodes in a node pool of its own, and this tree's
+ *	pool takes over those pools once their subtrees are done.
+ *
+ *	Expected time complexity is `O(n / p + log(n))` on `p` threads.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+BasicAVLTree<Key, Value, Compare, Allocator>::BasicAVLTree(const BasicAVLTree &other, ThreadPool &pool, size_t cutoff) :
+	root(nullptr), length(other.length), comp(other.comp), nodes(other.nodes.get_allocator()),
+	index(IndexAllocator(other.nodes.get_allocator())), cacheStamp(other.cacheStamp ? BasicAVLTree::newCacheStamp() : 0),
+	cacheOwner(0) {
+	this->root = BasicAVLTree::copyParallel(this->nodes, other.root, pool, cutoff);
+	this->rebuildIndex(other.hasHashIndex());
+}
+
+/**
+ *	Take over the nodes of the `other` AVL tree, which is left empty.
+ *	Nothing is copied, since the node pool holding those nodes, and the hash
+ *	index and the stamp of the cached pointers to them, are moved along.
+ *
+ *	Expected time complexity is `O(1)`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+BasicAVLTree<Key, Value, Compare, Allocator>::BasicAVLTree(BasicAVLTree &&other) noexcept :
+	root(std::exchange(other.root, nullptr)), length(std::exchange(other.length, 0)),
+	comp(std::move(other.comp)), nodes(std::move(other.nodes)), index(std::move(other.index)),
+	cacheStamp(std::exchange(other.cacheStamp, 0)), cacheOwner(std::exchange(other.cacheOwner, 0)) {}
+
+/**
+ *	Create an AVL tree holding the key-value pairs of `[first, last)`, which
+ *	is loaded by `bulkLoad()`. Since no result can be returned here, a
+ *	sequence rejected by the duplicate `policy` leaves the tree empty.
+ *
+ *	Expected time complexity is `O(n)` for sorted input, or `O(n log(n))` otherwise.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <std::input_iterator It, std::sentinel_for<It> S>
+BasicAVLTree<Key, Value, Compare, Allocator>::BasicAVLTree(
+	It first, S last, DuplicatePolicy policy, const Compare &comp, const Allocator &alloc
+) : BasicAVLTree(comp, alloc) {
+	this->bulkLoad(std::move(first), last, policy);
+}
+
+/**
+ *	Upon deletion, removes all nodes of the AVL tree.
+ *
+ *	The nodes are not returned to the node pool one at a time; instead the
+ *	whole pool is released at once.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+BasicAVLTree<Key, Value, Compare, Allocator>::~BasicAVLTree() {
+	this->release();
+}
+
+/**
+ *	Recursive helper method to traverse the other tree's nodes to make
+ *	copies of these nodes that are independent of each other.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::insert(AVLNode *&current, const AVLNode *other) {
+	current = BasicAVLTree::copyNodes(this->nodes, other);
+}
+
+/** Recursive helper method that copies a subtree in pre-order, creating every node in the pool `into`. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::copyNodes(Pool &into, const AVLNode *other) {
+	if (!other) {
+		return nullptr;
+	}
+
+	AVLNode *current = into.create(other->key, other->value);
+	current->left = BasicAVLTree::copyNodes(into, other->left);
+	current->right = BasicAVLTree::copyNodes(into, other->right);
+	current->update();
+	return current;
+}
+
+/**
+ *	Recursive helper method for the parallel copy constructor. The left subtree
+ *	is copied by the calling thread into `into`, and the right subtree may be
+ *	copied by another thread into a pool of its own, which `into` then adopts.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::copyParallel(
+	Pool &into, const AVLNode *other, ThreadPool &pool, size_t cutoff
+) {
+	if (!other) {
+		return nullptr;
+	} else if (other->count <= cutoff) {
+		into.reserve(other->count);
+		return BasicAVLTree::copyNodes(into, other);
+	}
+
+	AVLNode *current = into.create(other->key, other->value);
+	Pool rightPool(into.get_allocator());
+	pool.invoke(
+		[&] {current->left = BasicAVLTree::copyParallel(into, other->left, pool, cutoff);},
+		[&] {current->right = BasicAVLTree::copyParallel(rightPool, other->right, pool, cutoff);}
+	);
+	into.adopt(std::move(rightPool));
+	current->update();
+	return current;
+}
+
+/**
+ *	Removes every node of the tree, leaving the tree empty.
+ *
+ *	Keys and values that are not trivially destructible are destroyed first,
+ *	after which all the slabs of the node pool are released together.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::release() {
+	if constexpr (!std::is_trivially_destructible_v<AVLNode>) {
+		this->destroy(this->root);
+	}
+	this->nodes.release();
+	this->root = nullptr;
+	this->length = 0;
+	if constexpr (HAS_HASH_INDEX) {
+		if (this->index.isEnabled()) {this->index.clear();}
+	}
+	this->renewCacheStamp();
+}
+
+/** Removes every key-value pair, leaving the tree empty. A hash index or a lookup cache stays on. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::clear() {
+	this->release();
+}
+
+/**
+ *	Same as `clear()`, but the keys and values of subtrees with more than
+ *	`cutoff` nodes are destroyed in parallel on the threads of `pool`.
+ *	The slabs are then released together by the calling thread.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::clear(ThreadPool &pool, size_t cutoff) {
+	if constexpr (!std::is_trivially_destructible_v<AVLNode>) {
+		this->destroyParallel(this->root, pool, cutoff);
+	}
+	this->nodes.release();
+	this->root = nullptr;
+	this->length = 0;
+	if constexpr (HAS_HASH_INDEX) {
+		if (this->index.isEnabled()) {this->index.clear();}
+	}
+	this->renewCacheStamp();
+}
+
+/**
+ *	Recursive helper method for the parallel `clear()`. Destroying a node only
+ *	touches that node, so the two subtrees of a node can be destroyed at once.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::destroyParallel(AVLNode *current, ThreadPool &pool, size_t cutoff) {
+	if (!current) {
+		return;
+	} else if (current->count <= cutoff) {
+		this->destroy(current);
+		return;
+	}
+
+	pool.invoke(
+		[&] {this->destroyParallel(current->left, pool, cutoff);},
+		[&] {this->destroyParallel(current->right, pool, cutoff);}
+	);
+	std::destroy_at(current);
+}
+
+/**
+ *	Recursive helper method to traverse the nodes of the AVL tree
+ *	by destroying all the node's children before the current node.
+ *	The storage of each node is left to the node pool.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::destroy(AVLNode *current) {
+	if (current) {
+		this->destroy(current->left);
+		this->destroy(current->right);
+		std::destroy_at(current);
+	}
+	return;
+}
+
+/**
+ *	Assign a copy of the `other` AVL tree to this AVL tree.
+ *	Before deep copying the `other` tree's nodes, all the current nodes
+ *	must be removed. Like the copy constructor, this tree then has a hash
+ *	index or a lookup cache if and only if the `other` tree has one.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+BasicAVLTree<Key, Value, Compare, Allocator> & BasicAVLTree<Key, Value, Compare, Allocator>::operator=(const BasicAVLTree &other) {
+	if (this != &other) {
+		this->release();
+		this->length = other.length;
+		this->insert(this->root, other.root);
+		this->rebuildIndex(other.hasHashIndex());
+		this->cacheStamp = other.cacheStamp ? BasicAVLTree::newCacheStamp() : 0;
+		this->cacheOwner = 0;
+	}
+	return *this;
+}
+
+/**
+ *	Replace the nodes of this AVL tree with the nodes of the `other` AVL tree,
+ *	which is left empty. The current nodes are removed first.
+ *
+ *	Expected time complexity is `O(1)`, aside from removing the current nodes.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+BasicAVLTree<Key, Value, Compare, Allocator> & BasicAVLTree<Key, Value, Compare, Allocator>::operator=(BasicAVLTree &&other) noexcept {
+	if (this != &other) {
+		this->release();
+		this->root = std::exchange(other.root, nullptr);
+		this->length = std::exchange(other.length, 0);
+		this->comp = std::move(other.comp);
+		this->nodes = std::move(other.nodes);
+		this->index = std::move(other.index);
+		this->cacheStamp = std::exchange(other.cacheStamp, 0);
+		this->cacheOwner = std::exchange(other.cacheOwner, 0);
+	}
+	return *this;
+}
+
+/**
+ *	Creates a node, loaded with a key-value pair.
+ *	New nodes are allocated as leaf nodes, which they have no children.
+ *
+ *	The key and the value are constructed in place, so a key passed as an
+ *	rvalue is moved into the node instead of being copied.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K, typename... Args>
+BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode::AVLNode(K &&key, Args &&...args) :
+	Entry{KeyType(std::forward<K>(key)), ValueType(std::forward<Args>(args)...)},
+	height(0), count(1),
+	left(nullptr), right(nullptr) {
+	if constexpr (USES_STRING_ORDER) {
+		this->prefix = BasicAVLTree::packPrefix(this->key);
+	}
+}
+
+/**
+ *	Returns the number of existing key-value pairs in the tree.
+ *	The `size` only updates if a successful insertion or removal of a pair had occurred.
+ *
+ *	Expected time complexity is `O(1)`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::size() const {return this->length;}
+
+/**
+ *	Returns `true` if and only if the specified `key` is in the tree.
+ *
+ *	Expected time complexity is `O(log(n))`, or `O(1)` with a hash index.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::contains(const KeyType &key) const {
+	return this->findNode(key) != nullptr;
+}
+
+/**
+ *	Same as `contains()`, for any `key` the transparent comparator can compare
+ *	with the keys of the tree.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K> requires TransparentCompare<Compare>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::contains(const K &key) const {
+	return this->findNode(key) != nullptr;
+}
+
+/**
+ *	Packs the first `PREFIX_BYTES` bytes of the `key` into an integer, with the
+ *	first byte as the most significant one. Shorter keys are padded with zeros.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+uint64_t BasicAVLTree<Key, Value, Compare, Allocator>::packPrefix(std::string_view key) {
+	unsigned char bytes[PREFIX_BYTES] = {};
+	std::memcpy(bytes, key.data(), std::min(key.size(), PREFIX_BYTES));
+
+	uint64_t prefix = 0;
+	for (unsigned char byte : bytes) {
+		prefix = (prefix << 8) | byte;
+	}
+	return prefix;
+}
+
+/** Returns the number of leading bytes that are equal in `a` and `b`, up to `n`. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::matchLength(const char *a, const char *b, size_t n) {
+	size_t i = 0;
+	if constexpr (std::endian::native == std::endian::little) {
+		for (; i + sizeof(uint64_t) <= n; i += sizeof(uint64_t)) {
+			uint64_t x, y;
+			std::memcpy(&x, a + i, sizeof(x));
+			std::memcpy(&y, b + i, sizeof(y));
+			if (x != y) {
+				return i + std::countr_zero(x ^ y) / 8;
+			}
+		}
+	}
+	while (i < n && a[i] == b[i]) {++i;}
+	return i;
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K>
+BasicAVLTree<Key, Value, Compare, Allocator>::Probe<K>::Probe(const BasicAVLTree &tree, const K &key, AVLTreeStats::Operation operation) :
+	tree(tree), key(key), prefix(0), lowMatch(0), highMatch(0),
+	operation(operation), compared(0), longCompared(0) {
+	if constexpr (PREFIXED) {
+		this->view = std::string_view(key);
+		this->prefix = BasicAVLTree::packPrefix(this->view);
+	}
+}
+
+/** A descent ends with its probe, so this is where it is counted. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K>
+BasicAVLTree<Key, Value, Compare, Allocator>::Probe<K>::~Probe() {
+	if constexpr (KEEPS_STATS) {
+		this->tree.countDescent(this->operation, this->compared, this->longCompared);
+	}
+}
+
+/**
+ *	@return A negative integer if the search key is smaller; `0` if the keys are equal;
+ *	or a positive integer if the search key is greater.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K>
+int BasicAVLTree<Key, Value, Compare, Allocator>::Probe<K>::compareTo(const AVLNode *node) {
+	if constexpr (KEEPS_STATS) {++this->compared;}
+
+	if constexpr (!PREFIXED) {
+		return this->tree.compareKeys(this->key, node->key);
+	} else {
+		std::string_view nodeKey = node->key;
+		size_t shorter = std::min(this->view.size(), nodeKey.size());
+		size_t matched;
+		int cmp;
+
+		if (this->prefix != node->prefix) {
+			matched = std::min<size_t>(std::countl_zero(this->prefix ^ node->prefix) / 8, shorter);
+			cmp = (this->prefix < node->prefix) ? -1 : 1;
+		} else {
+			if constexpr (KEEPS_STATS) {++this->longCompared;}
+			size_t start = std::min(std::max(PREFIX_BYTES, std::min(this->lowMatch, this->highMatch)), shorter);
+			matched = start + BasicAVLTree::matchLength(this->view.data() + start, nodeKey.data() + start, shorter - start);
+			if (matched < shorter) {
+				cmp = (static_cast<unsigned char>(this->view[matched]) < static_cast<unsigned char>(nodeKey[matched])) ? -1 : 1;
+			} else if (this->view.size() == nodeKey.size()) {
+				cmp = 0;
+			} else {
+				cmp = (this->view.size() < nodeKey.size()) ? -1 : 1;
+			}
+		}
+
+		if (cmp < 0) {
+			this->highMatch = matched;
+		} else if (cmp > 0) {
+			this->lowMatch = matched;
+		}
+		return cmp;
+	}
+}
+
+/**
+ *	Descends from the root to the node holding `key`, with a single three-way
+ *	comparison per level. Returns `nullptr` once the descent falls off the tree.
+ *
+ *	If the tree has a hash index, and `key` hashes like the keys of the tree,
+ *	the node is looked up in the index instead. Otherwise, if the tree has a
+ *	lookup cache, the cache of the calling thread is tried first.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::findNode(const K &key) const {
+	if constexpr (HAS_HASH_INDEX && HASHES_LIKE_KEY<K>) {
+		if (this->index.isEnabled()) {
+			return this->index.find(BasicAVLTree::hashOf(key), [&](const AVLNode *node) {
+				return this->compareKeys(node->key, key) == 0;
+			});
+		}
+		if (this->cacheStamp) {
+			return this->findCached(key);
+		}
+	}
+
+	Probe<K> probe(*this, key);
+	AVLNode *current = this->root;
+	while (current) {
+		int cmp = probe.compareTo(current);
+		if (cmp < 0) {
+			current = current->left;
+		} else if (cmp > 0) {
+			current = current->right;
+		} else {
+			return current;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ *	Looks up every key of `keys` with interleaved descents, and calls
+ *	`found(i, node)` with the node holding `keys[i]`, or with `nullptr` if that
+ *	key isn't in the tree.
+ *
+ *	Up to `BATCH_LANES` descents run in lock-step. Each round advances every
+ *	unfinished descent by one level and prefetches the child it moves to, so
+ *	by the time the round comes back to that descent, its node has most likely
+ *	arrived in the cache. The cache misses of the descents overlap instead of
+ *	following one another.
+ *
+ *	If `sortFirst` is `true`, the keys are visited in ascending order, so that
+ *	the descents of one round share most of their paths from the root.
+ *
+ *	With a hash index, every key is looked up in the index instead, in order.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename Found>
+void BasicAVLTree<Key, Value, Compare, Allocator>::findBatch(std::span<const KeyType> keys, bool sortFirst, Found &&found) const {
+	if (this->hasHashIndex()) {
+		for (size_t i = 0; i < keys.size(); ++i) {found(i, this->findNode(keys[i]));}
+		return;
+	}
+
+	if (!this->root) {
+		for (size_t i = 0; i < keys.size(); ++i) {found(i, nullptr);}
+		return;
+	}
+
+	std::vector<size_t> order;
+	if (sortFirst) {
+		order.resize(keys.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return this->compareKeys(keys[a], keys[b]) < 0;
+		});
+	}
+
+	for (size_t first = 0; first < keys.size(); first += BATCH_LANES) {
+		size_t lanes = std::min(BATCH_LANES, keys.size() - first);
+		std::optional<Probe<KeyType>> probes[BATCH_LANES];
+		const AVLNode *current[BATCH_LANES];
+		size_t index[BATCH_LANES];
+		for (size_t j = 0; j < lanes; ++j) {
+			index[j] = sortFirst ? order[first + j] : first + j;
+			probes[j].emplace(*this, keys[index[j]]);
+			current[j] = this->root;
+		}
+
+		size_t active = lanes;
+		while (active > 0) {
+			for (size_t j = 0; j < lanes; ++j) {
+				const AVLNode *node = current[j];
+				if (!node) {continue;}
+
+				int cmp = probes[j]->compareTo(node);
+				if (cmp == 0) {
+					found(index[j], node);
+					current[j] = nullptr;
+					--active;
+					continue;
+				}
+
+				node = (cmp < 0) ? node->left : node->right;
+				if (node) {
+					/** A node spans two cache lines, with the key first and the child pointers last. */
+					__builtin_prefetch(node);
+					__builtin_prefetch(&node->right);
+				} else {
+					found(index[j], nullptr);
+					--active;
+				}
+				current[j] = node;
+			}
+		}
+	}
+}
+
+/**
+ *	Insert a new key-value pair into the tree.
+ *	If a key was not in the tree, the new key is uniquely inserted, so that
+ *	should return `true`. Otherwise, it returns `false` even though a new value
+ *	will be replacing the old value corresponding to an existing key.
+ *
+ *	The descent records the nodes it passes through, and after a new leaf is
+ *	linked, those nodes are rebalanced from the bottom up until a subtree
+ *	keeps its height.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::insert(const KeyType &key, ValueType value) {
+	auto [node, inserted] = this->insertUnique(nullptr, key, std::move(value));
+	if (!inserted) {node->value = std::move(value);}
+	return inserted;
+}
+
+/** Same as the above, but a new node takes over the `key` instead of copying it. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::insert(KeyType &&key, ValueType value) {
+	auto [node, inserted] = this->insertUnique(nullptr, std::move(key), std::move(value));
+	if (!inserted) {node->value = std::move(value);}
+	return inserted;
+}
+
+/**
+ *	Descends to the node holding `key`, or to the empty slot where that key
+ *	belongs. If the key is missing, a node is created in that slot from `key`
+ *	and `args`, then the nodes on the way down are rebalanced.
+ *
+ *	Neither `key` nor `args` are used if the key is already in the tree. With
+ *	a hash index, a key that is in the tree is found without the descent,
+ *	unless the path to it is asked for.
+ *
+ *	If `found` is set, it receives the path from the root to the node holding
+ *	the key, for an iterator to that node.
+ *
+ *	@return The node holding the key, and whether that node was just created.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K, typename... Args>
+std::pair<typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode *, bool> BasicAVLTree<Key, Value, Compare, Allocator>::insertUnique(Path *found, K &&key, Args &&...args) {
+	if (!found && this->hasHashIndex()) {
+		if (AVLNode *node = this->findNode(key)) {return {node, false};}
+	}
+
+	Path path;
+	Probe<std::remove_cvref_t<K>> probe(*this, key, AVLTreeStats::Operation::INSERT);
+	AVLNode **slot = &this->root;
+	while (*slot) {
+		AVLNode *current = *slot;
+		int cmp = probe.compareTo(current);
+		if (cmp == 0) {
+			if (found) {
+				*found = path;
+				found->push(current);
+			}
+			return {current, false};
+		}
+		path.push(current);
+		slot = (cmp < 0) ? &current->left : &current->right;
+	}
+
+	AVLNode *node = this->createNode(std::forward<K>(key), std::forward<Args>(args)...);
+	*slot = node;
+	++this->length;
+	size_t unrotated = this->retrace(path, 1);
+	if (found) {*found = this->pathAfterInsert(path, unrotated, node);}
+	return {node, true};
+}
+
+/**
+ *	Returns the path from the root to a `node` that was just inserted below the
+ *	`path`, whose first `unrotated` nodes were left linked by the retrace.
+ *
+ *	An insertion rotates at most once, at the first node that wasn't left
+ *	linked. That rotation only reorders the nodes at that depth and the next
+ *	two, so the new path is rebuilt from the old one by comparing pointers,
+ *	without comparing any key again:
+ *	- If the node at that depth is still in place, nothing was rotated.
+ *	- After a single rotation, its child took its place and the rest of the
+ *	  path follows that child as before.
+ *	- After a double rotation, its grandchild took its place, with the node and
+ *	  its child below. Only one of those two holds the rest of the path.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::Path BasicAVLTree<Key, Value, Compare, Allocator>::pathAfterInsert(const Path &path, size_t unrotated, AVLNode *node) const {
+	/* The old path, followed by the new node. */
+	auto at = [&](size_t i) {return (i < path.size()) ? path[i] : node;};
+
+	Path result;
+	for (size_t i = 0; i < unrotated; ++i) {result.push(path[i]);}
+
+	size_t i = unrotated;
+	AVLNode *top = this->root;
+	if (i > 0) {
+		AVLNode *parent = path[i - 1];
+		bool left = (parent->left == at(i)) || (parent->left == at(i + 1)) || (parent->left == at(i + 2));
+		top = left ? parent->left : parent->right;
+	}
+
+	if (top == at(i + 1)) {
+		++i;
+	} else if (top != at(i)) {
+		result.push(top);
+		if (top == node) {
+			return result;
+		}
+		AVLNode *next = at(i + 3);
+		AVLNode *child = at(i + 1);
+		bool holdsNext = (child->left == next) || (child->right == next);
+		result.push(holdsNext ? child : at(i));
+		i += 3;
+	}
+
+	for (; i < path.size(); ++i) {result.push(path[i]);}
+	result.push(node);
+	return result;
+}
+
+/**
+ *	Replaces the contents of the tree with the key-value pairs of `[first, last)`.
+ *	Each element is either an `Entry` or a pair-like type such as `std::pair`.
+ *
+ *	A sorted sequence of forward iterators is loaded as is. Any other sequence
+ *	is moved into a buffer first, which is sorted without reordering equal keys.
+ *	The tree is then built in one in-order pass, with every node coming from a
+ *	single slab, and with no rotations.
+ *
+ *	Pairs with equal keys are handled by the `policy`. If the policy rejects
+ *	them, the tree is left as it was.
+ *
+ *	@return `true` if the sequence was loaded, or `false` if it was rejected.
+ *
+ *	Expected time complexity is `O(n)` for sorted input, or `O(n log(n))` otherwise.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <std::input_iterator It, std::sentinel_for<It> S>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::bulkLoad(It first, S last, DuplicatePolicy policy) {
+	if constexpr (std::forward_iterator<It>) {
+		std::optional<SortedRun> run = this->scanSorted(first, last);
+		if (run) {
+			return this->loadSorted(first, last, *run, policy);
+		}
+	}
+
+	std::vector<std::pair<KeyType, ValueType>> buffer = this->sortedBuffer(first, last);
+	return this->loadSorted(
+		std::make_move_iterator(buffer.begin()), std::make_move_iterator(buffer.end()),
+		*this->scanSorted(buffer.begin(), buffer.end()), policy
+	);
+}
+
+/**
+ *	Moves the key-value pairs of `[first, last)` into a buffer, which is sorted
+ *	without reordering equal keys.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename It, typename S>
+std::vector<std::pair<typename BasicAVLTree<Key, Value, Compare, Allocator>::KeyType, typename BasicAVLTree<Key, Value, Compare, Allocator>::ValueType>> BasicAVLTree<Key, Value, Compare, Allocator>::sortedBuffer(It first, const S &last) const {
+	std::vector<std::pair<KeyType, ValueType>> buffer;
+	if constexpr (std::sized_sentinel_for<S, It>) {
+		buffer.reserve(last - first);
+	}
+	for (; first != last; ++first) {
+		auto &&entry = *first;
+		buffer.emplace_back(
+			BasicAVLTree::keyOf(std::forward<decltype(entry)>(entry)),
+			BasicAVLTree::valueOf(std::forward<decltype(entry)>(entry))
+		);
+	}
+
+	std::stable_sort(buffer.begin(), buffer.end(), [this](const auto &a, const auto &b) {
+		return this->compareKeys(a.first, b.first) < 0;
+	});
+	return buffer;
+}
+
+/** The key of an element of a bulk load, which is either an `Entry` or pair-like. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename E>
+decltype(auto) BasicAVLTree<Key, Value, Compare, Allocator>::keyOf(E &&entry) {
+	if constexpr (requires {entry.key;}) {
+		return (std::forward<E>(entry).key);
+	} else {
+		return (std::get<0>(std::forward<E>(entry)));
+	}
+}
+
+/** The value of an element of a bulk load, which is either an `Entry` or pair-like. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename E>
+decltype(auto) BasicAVLTree<Key, Value, Compare, Allocator>::valueOf(E &&entry) {
+	if constexpr (requires {entry.value;}) {
+		return (std::forward<E>(entry).value);
+	} else {
+		return (std::get<1>(std::forward<E>(entry)));
+	}
+}
+
+/**
+ *	Counts the elements and the distinct keys of `[first, last)`, or returns
+ *	nothing if the keys are not in ascending order.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename It, typename S>
+std::optional<typename BasicAVLTree<Key, Value, Compare, Allocator>::SortedRun> BasicAVLTree<Key, Value, Compare, Allocator>::scanSorted(It first, const S &last) const {
+	if (first == last) {
+		return SortedRun{0, 0};
+	}
+
+	SortedRun run{1, 1};
+	It prev = first;
+	while (++first != last) {
+		int cmp = this->compareKeys(BasicAVLTree::keyOf(*prev), BasicAVLTree::keyOf(*first));
+		if (cmp > 0) {
+			return std::nullopt;
+		}
+		++run.length;
+		if (cmp < 0) {++run.distinct;}
+		prev = first;
+	}
+	return run;
+}
+
+/** Replaces the contents of the tree with a sorted sequence, as described by `run`. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename It, typename S>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::loadSorted(It first, const S &last, const SortedRun &run, DuplicatePolicy policy) {
+	if (policy == DuplicatePolicy::REJECT && run.distinct != run.length) {
+		return false;
+	}
+
+	this->release();
+	this->nodes.reserve(run.distinct);
+	this->root = this->buildBalanced(first, last, run.distinct, policy);
+	this->length = run.distinct;
+	return true;
+}
+
+/**
+ *	Recursive helper method that builds a perfectly balanced subtree from the
+ *	next `n` distinct keys of a sorted sequence, consuming them in order.
+ *
+ *	The left half is built first, then the node holding the middle key, then
+ *	the right half. Heights and subtree sizes are set on the way back up.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename It, typename S>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::buildBalanced(It &it, const S &last, size_t n, DuplicatePolicy policy) {
+	if (n == 0) {
+		return nullptr;
+	}
+
+	AVLNode *left = this->buildBalanced(it, last, (n - 1) / 2, policy);
+
+	It pick = it;
+	for (++it; it != last && this->compareKeys(BasicAVLTree::keyOf(*it), BasicAVLTree::keyOf(*pick)) == 0; ++it) {
+		if (policy == DuplicatePolicy::KEEP_LAST) {pick = it;}
+	}
+
+	auto &&entry = *pick;
+	AVLNode *node = this->createNode(
+		BasicAVLTree::keyOf(std::forward<decltype(entry)>(entry)),
+		BasicAVLTree::valueOf(std::forward<decltype(entry)>(entry))
+	);
+	node->left = left;
+	node->right = this->buildBalanced(it, last, n - 1 - (n - 1) / 2, policy);
+	node->update();
+	return node;
+}
+
+/**
+ *	Same as the other `bulkLoad()`, but the tree is built in parallel on the
+ *	threads of `pool`. Sorting unsorted input and choosing one pair per key
+ *	are still done by the calling thread, after which the two halves of every
+ *	range of more than `cutoff` keys are built at once, each thread creating
+ *	nodes in a pool of its own.
+ *
+ *	@return `true` if the sequence was loaded, or `false` if it was rejected.
+ *
+ *	Expected time complexity is `O(n)` for sorted input, or `O(n log(n))` otherwise,
+ *	of which building takes `O(n / p + log(n))` on `p` threads.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <std::input_iterator It, std::sentinel_for<It> S>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::bulkLoad(It first, S last, ThreadPool &pool, DuplicatePolicy policy, size_t cutoff) {
+	if constexpr (std::forward_iterator<It>) {
+		if (this->scanSorted(first, last)) {
+			return this->loadSortedParallel(first, last, policy, pool, cutoff);
+		}
+	}
+
+	std::vector<std::pair<KeyType, ValueType>> buffer = this->sortedBuffer(first, last);
+	return this->loadSortedParallel(
+		std::make_move_iterator(buffer.begin()), std::make_move_iterator(buffer.end()), policy, pool, cutoff
+	);
+}
+
+/**
+ *	Replaces the contents of the tree with a sorted sequence. The element
+ *	kept for each distinct key is picked first, so that the builder can split
+ *	the keys into halves by position.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename It, typename S>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::loadSortedParallel(
+	It first, const S &last, DuplicatePolicy policy, ThreadPool &pool, size_t cutoff
+) {
+	std::vector<It> picks;
+	bool duplicates = false;
+	while (first != last) {
+		It pick = first;
+		for (++first; first != last && this->compareKeys(BasicAVLTree::keyOf(*first), BasicAVLTree::keyOf(*pick)) == 0; ++first) {
+			duplicates = true;
+			if (policy == DuplicatePolicy::KEEP_LAST) {pick = first;}
+		}
+		picks.push_back(pick);
+	}
+	if (policy == DuplicatePolicy::REJECT && duplicates) {
+		return false;
+	}
+
+	this->release();
+	this->root = BasicAVLTree::buildParallel(this->nodes, picks.data(), picks.size(), pool, cutoff);
+	this->length = picks.size();
+	this->rebuildIndex(this->hasHashIndex());
+	return true;
+}
+
+/** Recursive helper method that builds a perfectly balanced subtree from `n` picked elements. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename It>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::buildPicked(Pool &into, const It *picks, size_t n) {
+	if (n == 0) {
+		return nullptr;
+	}
+
+	size_t middle = (n - 1) / 2;
+	auto &&entry = *picks[middle];
+	AVLNode *node = into.create(
+		BasicAVLTree::keyOf(std::forward<decltype(entry)>(entry)),
+		BasicAVLTree::valueOf(std::forward<decltype(entry)>(entry))
+	);
+	node->left = BasicAVLTree::buildPicked(into, picks, middle);
+	node->right = BasicAVLTree::buildPicked(into, picks + middle + 1, n - 1 - middle);
+	node->update();
+	return node;
+}
+
+/**
+ *	Recursive helper method that builds the same subtree as `buildPicked()`,
+ *	with the two halves of more than `cutoff` elements built at once.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename It>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::buildParallel(
+	Pool &into, const It *picks, size_t n, ThreadPool &pool, size_t cutoff
+) {
+	if (n <= cutoff) {
+		into.reserve(n);
+		return BasicAVLTree::buildPicked(into, picks, n);
+	}
+
+	size_t middle = (n - 1) / 2;
+	auto &&entry = *picks[middle];
+	AVLNode *node = into.create(
+		BasicAVLTree::keyOf(std::forward<decltype(entry)>(entry)),
+		BasicAVLTree::valueOf(std::forward<decltype(entry)>(entry))
+	);
+
+	Pool rightPool(into.get_allocator());
+	pool.invoke(
+		[&] {node->left = BasicAVLTree::buildParallel(into, picks, middle, pool, cutoff);},
+		[&] {node->right = BasicAVLTree::buildParallel(rightPool, picks + middle + 1, n - 1 - middle, pool, cutoff);}
+	);
+	into.adopt(std::move(rightPool));
+	node->update();
+	return node;
+}
+
+/**
+ *	Inserts every key-value pair of `[first, last)`, as if each was passed to
+ *	`insert()` in order. Each element is either an `Entry` or a pair-like type
+ *	such as `std::pair`, and a key that is given more than once, or that is
+ *	already in the tree, ends up with the last value given for it.
+ *
+ *	The pairs are sorted first, unless they already are. A batch that is
+ *	small next to the tree is then inserted in ascending order, each descent
+ *	starting from the deepest node of the previous one whose subtree holds
+ *	the next key, rather than from the root. A larger batch is merged with the
+ *	nodes of the tree in one pass, and the nodes are linked into a balanced
+ *	tree again without copying any key.
+ *
+ *	@return The number of keys that were not in the tree before.
+ *
+ *	Expected time complexity is `O(k * log(n))` for `k` pairs, or `O(n + k)` for large batches,
+ *	plus `O(k * log(k))` if the pairs are not sorted.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <std::input_iterator It, std::sentinel_for<It> S>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::insertBatch(It first, S last) {
+	if constexpr (std::forward_iterator<It>) {
+		std::optional<SortedRun> run = this->scanSorted(first, last);
+		if (run) {
+			return this->insertSorted(first, last, run->length);
+		}
+	}
+
+	std::vector<std::pair<KeyType, ValueType>> buffer = this->sortedBuffer(first, last);
+	return this->insertSorted(std::make_move_iterator(buffer.begin()), std::make_move_iterator(buffer.end()), buffer.size());
+}
+
+/**
+ *	Removes every key of `[first, last)` that is in the tree, as if each was
+ *	passed to `remove()`. The keys are sorted first, unless they already are,
+ *	and removed the same way as `insertBatch()` inserts.
+ *
+ *	@return The number of keys that were removed.
+ *
+ *	Expected time complexity is `O(k * log(n))` for `k` keys, or `O(n + k)` for large batches,
+ *	plus `O(k * log(k))` if the keys are not sorted.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <std::input_iterator It, std::sentinel_for<It> S>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::removeBatch(It first, S last) {
+	auto ascending = [this](const auto &a, const auto &b) {return this->compareKeys(a, b) < 0;};
+	if constexpr (std::forward_iterator<It>) {
+		if (std::is_sorted(first, last, ascending)) {
+			return this->removeSorted(first, last, std::ranges::distance(first, last));
+		}
+	}
+
+	std::vector<KeyType> buffer(first, last);
+	std::sort(buffer.begin(), buffer.end(), ascending);
+	return this->removeSorted(buffer.begin(), buffer.end(), buffer.size());
+}
+
+/** Inserts the `count` sorted pairs of `[first, last)`, as described by `insertBatch()`. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename It, typename S>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::insertSorted(It first, const S &last, size_t count) {
+	size_t inserted = 0;
+	if (count * BasicAVLTree::REBUILD_RATIO < this->length) {
+		Path finger;
+		for (; first != last; ++first) {
+			auto &&entry = *first;
+			const auto &key = BasicAVLTree::keyOf(entry);
+			Probe<std::remove_cvref_t<decltype(key)>> probe(*this, key, AVLTreeStats::Operation::INSERT);
+			AVLNode **slot = this->fingerSlot(finger, key);
+			int cmp = 1;
+			while (*slot && (cmp = probe.compareTo(*slot)) != 0) {
+				finger.push(*slot);
+				slot = (cmp < 0) ? &(*slot)->left : &(*slot)->right;
+			}
+
+			if (*slot) {
+				(*slot)->value = BasicAVLTree::valueOf(std::forward<decltype(entry)>(entry));
+				finger.push(*slot);
+			} else {
+				*slot = this->createNode(
+					BasicAVLTree::keyOf(std::forward<decltype(entry)>(entry)),
+					BasicAVLTree::valueOf(std::forward<decltype(entry)>(entry))
+				);
+				++inserted;
+				finger.truncate(this->retrace(finger, 1));
+			}
+		}
+		this->length += inserted;
+		return inserted;
+	}
+
+	std::vector<AVLNode *> existing;
+	existing.reserve(this->length);
+	BasicAVLTree::collectNodes(existing, this->root);
+
+	std::vector<AVLNode *> merged;
+	merged.reserve(this->length + count);
+	auto old = existing.begin();
+	while (first != last) {
+		/** Of the pairs with equal keys, only the last one is kept. */
+		It pick = first;
+		for (++first; first != last && this->compareKeys(BasicAVLTree::keyOf(*first), BasicAVLTree::keyOf(*pick)) == 0; ++first) {
+			pick = first;
+		}
+
+		auto &&entry = *pick;
+		int cmp = -1;
+		while (old != existing.end() && (cmp = this->compareKeys((*old)->key, BasicAVLTree::keyOf(entry))) < 0) {
+			merged.push_back(*old++);
+		}
+
+		if (old != existing.end() && cmp == 0) {
+			(*old)->value = BasicAVLTree::valueOf(std::forward<decltype(entry)>(entry));
+			merged.push_back(*old++);
+		} else {
+			merged.push_back(this->createNode(
+				BasicAVLTree::keyOf(std::forward<decltype(entry)>(entry)),
+				BasicAVLTree::valueOf(std::forward<decltype(entry)>(entry))
+			));
+			++inserted;
+		}
+	}
+	merged.insert(merged.end(), old, existing.end());
+
+	this->root = BasicAVLTree::linkBalanced(merged.data(), merged.size());
+	this->length += inserted;
+	return inserted;
+}
+
+/** Removes the `count` sorted keys of `[first, last)`, as described by `removeBatch()`. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename It, typename S>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::removeSorted(It first, const S &last, size_t count) {
+	size_t removed = 0;
+	if (count * BasicAVLTree::REBUILD_RATIO < this->length) {
+		Path finger;
+		for (; first != last; ++first) {
+			const auto &key = *first;
+			Probe<std::remove_cvref_t<decltype(key)>> probe(*this, key, AVLTreeStats::Operation::REMOVE);
+			AVLNode **slot = this->fingerSlot(finger, key);
+			int cmp = 1;
+			while (*slot && (cmp = probe.compareTo(*slot)) != 0) {
+				finger.push(*slot);
+				slot = (cmp < 0) ? &(*slot)->left : &(*slot)->right;
+			}
+
+			/**	A node with two children is replaced by its successor, and the path
+				to that successor is not a path to the keys between the two. */
+			size_t depth = finger.size();
+			if (this->removeNode(*slot, finger)) {
+				finger.truncate(std::min(finger.size(), depth + 1));
+				++removed;
+			}
+		}
+		this->length -= removed;
+		return removed;
+	}
+
+	std::vector<AVLNode *> existing;
+	existing.reserve(this->length);
+	BasicAVLTree::collectNodes(existing, this->root);
+
+	std::vector<AVLNode *> kept;
+	kept.reserve(this->length);
+	auto old = existing.begin();
+	for (; first != last && old != existing.end(); ++first) {
+		int cmp = -1;
+		while (old != existing.end() && (cmp = this->compareKeys((*old)->key, *first)) < 0) {
+			kept.push_back(*old++);
+		}
+		if (old != existing.end() && cmp == 0) {
+			this->destroyNode(*old++);
+			++removed;
+		}
+	}
+	kept.insert(kept.end(), old, existing.end());
+
+	this->root = BasicAVLTree::linkBalanced(kept.data(), kept.size());
+	this->length -= removed;
+	return removed;
+}
+
+/**
+ *	Finds where the descent for `key` can start, given the `finger`, which is
+ *	the path to the previous key of an ascending batch.
+ *
+ *	Every key in the subtree of a node on the path is greater than the previous
+ *	key's lower bounds, so only the upper bounds are checked. Those are the keys
+ *	of the nodes where the path turned left. The path is shortened to the
+ *	ancestors of the deepest node whose subtree can still hold `key`.
+ *
+ *	@return The pointer that links that node to its parent, or the root pointer.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode ** BasicAVLTree<Key, Value, Compare, Allocator>::fingerSlot(Path &finger, const K &key) {
+	if (finger.empty()) {
+		return &this->root;
+	}
+
+	size_t start = finger.size() - 1;
+	for (size_t i = start; i-- > 0;) {
+		if (finger[i]->left != finger[i + 1]) {continue;}
+		if (this->compareKeys(key, finger[i]->key) < 0) {break;}
+		start = i;
+	}
+
+	AVLNode **slot = &this->slotOf(finger, start);
+	finger.truncate(start);
+	return slot;
+}
+
+/** Recursive helper method that appends the nodes of a subtree in ascending order of their keys. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::collectNodes(std::vector<AVLNode *> &nodeList, AVLNode *current) {
+	if (current) {
+		BasicAVLTree::collectNodes(nodeList, current->left);
+		nodeList.push_back(current);
+		BasicAVLTree::collectNodes(nodeList, current->right);
+	}
+}
+
+/**
+ *	Recursive helper method that links `n` nodes, sorted by their keys, into a
+ *	perfectly balanced subtree, the same shape `buildBalanced()` gives.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::linkBalanced(AVLNode *const *nodeList, size_t n) {
+	if (n == 0) {
+		return nullptr;
+	}
+
+	size_t middle = (n - 1) / 2;
+	AVLNode *node = nodeList[middle];
+	node->left = BasicAVLTree::linkBalanced(nodeList, middle);
+	node->right = BasicAVLTree::linkBalanced(nodeList + middle + 1, n - 1 - middle);
+	node->update();
+	return node;
+}
+
+/**
+ *	Removes every key-value pair whose key is in the range from `low` to
+ *	`high`, where each bound is included, excluded, or ignored as with
+ *	`countRange()`.
+ *
+ *	The tree is split at both bounds and the outer parts are joined again, so
+ *	no rebalancing walk is done per removed key. Only destroying the removed
+ *	pairs themselves takes time proportional to their number.
+ *
+ *	@return The number of pairs that were removed.
+ *
+ *	Expected time complexity is `O(log(n) + k)` for `k` removed pairs.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::removeRange(const KeyType &low, const KeyType &high, Bound lowBound, Bound highBound) {
+	if (lowBound != Bound::UNBOUNDED && highBound != Bound::UNBOUNDED && this->compareKeys(low, high) > 0) {
+		return 0;
+	}
+
+	AVLNode *below = nullptr;
+	AVLNode *middle = this->root;
+	if (lowBound != Bound::UNBOUNDED) {
+		AVLNode *equal = this->splitNodes(this->root, low, below, middle);
+		if (equal && lowBound == Bound::EXCLUSIVE) {
+			below = BasicAVLTree::joinNodes(below, equal, nullptr);
+		} else if (equal) {
+			middle = BasicAVLTree::joinNodes(nullptr, equal, middle);
+		}
+	}
+
+	AVLNode *above = nullptr;
+	if (highBound != Bound::UNBOUNDED) {
+		AVLNode *equal = this->splitNodes(middle, high, middle, above);
+		if (equal && highBound == Bound::EXCLUSIVE) {
+			above = BasicAVLTree::joinNodes(nullptr, equal, above);
+		} else if (equal) {
+			middle = BasicAVLTree::joinNodes(middle, equal, nullptr);
+		}
+	}
+
+	size_t removed = BasicAVLTree::countOf(middle);
+	this->discard(middle);
+	this->root = BasicAVLTree::joinNodes(below, above);
+	this->length -= removed;
+	return removed;
+}
+
+/**
+ *	Moves every key-value pair whose key is greater than or equal to `key`
+ *	into a new tree, which is returned. This tree keeps the smaller keys.
+ *
+ *	No node is copied. The two trees share the slabs their nodes were created
+ *	in, until both of them have released those nodes. If this tree has a hash
+ *	index, the moved pairs are taken out of it, and the new tree gets an index
+ *	of its own. The same goes for a lookup cache.
+ *
+ *	Expected time complexity is `O(log(n))`, plus `O(k)` for `k` moved pairs with a hash index.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+BasicAVLTree<Key, Value, Compare, Allocator> BasicAVLTree<Key, Value, Compare, Allocator>::split(const KeyType &key) {
+	AVLNode *less;
+	AVLNode *greater;
+	AVLNode *equal = this->splitNodes(this->root, key, less, greater);
+	if (equal) {greater = BasicAVLTree::joinNodes(nullptr, equal, greater);}
+
+	BasicAVLTree upper(this->comp, this->get_allocator());
+	upper.root = greater;
+	upper.length = BasicAVLTree::countOf(greater);
+	if (upper.length) {upper.nodes = this->nodes.split(upper.length);}
+	if (this->hasHashIndex()) {
+		this->unindexNodes(greater);
+		upper.rebuildIndex(true);
+	}
+	if (this->cacheStamp) {
+		this->renewCacheStamp();
+		upper.cacheStamp = BasicAVLTree::newCacheStamp();
+	}
+
+	this->root = less;
+	this->length -= upper.length;
+	return upper;
+}
+
+/**
+ *	Appends the pair of `key` and `value`, and then every pair of the `right`
+ *	tree, which is left empty. Every key of this tree must be smaller than
+ *	`key`, which must be smaller than every key of the `right` tree.
+ *
+ *	@return `false`, leaving both trees as they were, if the keys are not in that order.
+ *
+ *	Expected time complexity is `O(log(n) + log(m))` for a `right` tree of `m` pairs,
+ *	plus `O(m)` if this tree has a hash index.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::join(KeyType key, ValueType value, BasicAVLTree &&right) {
+	if (&right == this) {
+		return false;
+	}
+
+	const AVLNode *max = this->root;
+	while (max && max->right) {max = max->right;}
+	const AVLNode *min = right.root;
+	while (min && min->left) {min = min->left;}
+	if ((max && this->compareKeys(max->key, key) >= 0) || (min && this->compareKeys(key, min->key) >= 0)) {
+		return false;
+	}
+
+	AVLNode *pivot = this->createNode(std::move(key), std::move(value));
+	AVLNode *rightRoot = this->adoptNodes(right);
+	this->root = BasicAVLTree::joinNodes(this->root, pivot, rightRoot);
+	this->length = BasicAVLTree::countOf(this->root);
+	return true;
+}
+
+/**
+ *	Appends every pair of the `right` tree, which is left empty. Every key of
+ *	this tree must be smaller than every key of the `right` tree.
+ *
+ *	@return `false`, leaving both trees as they were, if the keys are not in that order.
+ *
+ *	Expected time complexity is `O(log(n) + log(m))` for a `right` tree of `m` pairs,
+ *	plus `O(m)` if this tree has a hash index.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::join(BasicAVLTree &&right) {
+	if (&right == this) {
+		return false;
+	}
+
+	const AVLNode *max = this->root;
+	while (max && max->right) {max = max->right;}
+	const AVLNode *min = right.root;
+	while (min && min->left) {min = min->left;}
+	if (max && min && this->compareKeys(max->key, min->key) >= 0) {
+		return false;
+	}
+
+	AVLNode *rightRoot = this->adoptNodes(right);
+	this->root = BasicAVLTree::joinNodes(this->root, rightRoot);
+	this->length = BasicAVLTree::countOf(this->root);
+	return true;
+}
+
+/**
+ *	Adds every pair of the `other` tree to this tree. A key that is in both
+ *	trees takes the value it has in the `other` tree, as if every pair of
+ *	the `other` tree was inserted.
+ *
+ *	@return The number of keys that were not in this tree before.
+ *
+ *	Expected time complexity is `O(m * log(n / m + 1))` for a smaller tree of `m` pairs,
+ *	plus `O(m)` to copy the `other` tree.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::unionWith(const BasicAVLTree &other) {
+	if (&other == this) {
+		return 0;
+	}
+
+	BasicAVLTree copy(other);
+	return this->unionWith(std::move(copy));
+}
+
+/** Same as the above, but the nodes of the `other` tree are taken over instead of copied. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::unionWith(BasicAVLTree &&other) {
+	if (&other == this) {
+		return 0;
+	}
+
+	size_t before = this->length;
+	this->renewCacheStamp();
+	AVLNode *theirs = this->adoptNodes(other);
+	this->root = this->unionNodes(this->root, theirs);
+	this->length = BasicAVLTree::countOf(this->root);
+	return this->length - before;
+}
+
+/**
+ *	Same as the above, but the two halves of every union of more than
+ *	`cutoff` nodes are merged in parallel on the threads of `pool`. The nodes
+ *	of this tree whose keys the `other` tree also holds are collected while
+ *	merging, and destroyed by the calling thread afterwards.
+ *
+ *	Expected time complexity is `O(m * log(n / m + 1))` work for a smaller tree of `m` pairs,
+ *	spread across the threads.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::unionWith(BasicAVLTree &&other, ThreadPool &pool, size_t cutoff) {
+	if (&other == this) {
+		return 0;
+	}
+
+	size_t before = this->length;
+	this->renewCacheStamp();
+	AVLNode *theirs = this->adoptNodes(other);
+	std::vector<AVLNode *> replaced;
+	this->root = this->unionParallel(this->root, theirs, replaced, pool, cutoff);
+	for (AVLNode *node : replaced) {this->destroyNode(node);}
+	this->length = BasicAVLTree::countOf(this->root);
+	return this->length - before;
+}
+
+/**
+ *	Removes every pair whose key is not in the `other` tree.
+ *
+ *	@return The number of pairs that were removed.
+ *
+ *	Expected time complexity is `O(m * log(n / m + 1))` for a smaller tree of `m` pairs,
+ *	plus `O(k)` to destroy `k` removed pairs.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::intersect(const BasicAVLTree &other) {
+	if (&other == this) {
+		return 0;
+	}
+
+	size_t before = this->length;
+	this->renewCacheStamp();
+	this->root = this->intersectNodes(this->root, other.root);
+	this->length = BasicAVLTree::countOf(this->root);
+	return before - this->length;
+}
+
+/**
+ *	Removes every pair whose key is in the `other` tree.
+ *
+ *	@return The number of pairs that were removed.
+ *
+ *	Expected time complexity is `O(m * log(n / m + 1))` for a smaller tree of `m` pairs.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::difference(const BasicAVLTree &other) {
+	size_t before = this->length;
+	if (&other == this) {
+		this->release();
+		return before;
+	}
+
+	this->renewCacheStamp();
+	this->root = this->differenceNodes(this->root, other.root);
+	this->length = BasicAVLTree::countOf(this->root);
+	return before - this->length;
+}
+
+/** The height of a subtree, which is `-1` for an empty one. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+ssize_t BasicAVLTree<Key, Value, Compare, Allocator>::heightOf(const AVLNode *node) {
+	return node ? static_cast<ssize_t>(node->height) : -1;
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::countOf(const AVLNode *node) {
+	return node ? node->count : 0;
+}
+
+/**
+ *	Joins two balanced subtrees with the `pivot` node in between, where every
+ *	key of `left` is smaller than the pivot's, which is smaller than every key
+ *	of `right`.
+ *
+ *	The pivot is linked in along the inner spine of the taller subtree, at the
+ *	first node no taller than the other subtree plus one. The nodes on the way
+ *	back up are rebalanced with the same rotations as an insertion.
+ *
+ *	Expected time complexity is `O(|height(left) - height(right)| + 1)`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::joinNodes(AVLNode *left, AVLNode *pivot, AVLNode *right) {
+	ssize_t leftHeight = BasicAVLTree::heightOf(left);
+	ssize_t rightHeight = BasicAVLTree::heightOf(right);
+
+	if (leftHeight > rightHeight + 1) {
+		left->right = BasicAVLTree::joinNodes(left->right, pivot, right);
+		BasicAVLTree::rebalance(left);
+		return left;
+	} else if (rightHeight > leftHeight + 1) {
+		right->left = BasicAVLTree::joinNodes(left, pivot, right->left);
+		BasicAVLTree::rebalance(right);
+		return right;
+	}
+
+	pivot->left = left;
+	pivot->right = right;
+	pivot->update();
+	return pivot;
+}
+
+/** Joins two balanced subtrees without a pivot, by taking the smallest node of `right` as the pivot. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::joinNodes(AVLNode *left, AVLNode *right) {
+	if (!right) {
+		return left;
+	}
+
+	AVLNode *min;
+	right = BasicAVLTree::detachMin(right, min);
+	return BasicAVLTree::joinNodes(left, min, right);
+}
+
+/** Unlinks the smallest node of a subtree into `min`, and rebalances the nodes above it. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::detachMin(AVLNode *node, AVLNode *&min) {
+	if (!node->left) {
+		min = node;
+		return node->right;
+	}
+
+	node->left = BasicAVLTree::detachMin(node->left, min);
+	BasicAVLTree::rebalance(node);
+	return node;
+}
+
+/**
+ *	Splits a subtree into the balanced subtrees of the keys smaller than `key`,
+ *	stored in `less`, and of the keys greater than `key`, stored in `greater`.
+ *
+ *	On the way back up from `key`, each node passed is joined with its subtree
+ *	on the far side, and those joins cost `O(log(n))` altogether.
+ *
+ *	@return The node holding `key`, unlinked from the tree, or `nullptr` if there is none.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::splitNodes(AVLNode *node, const K &key, AVLNode *&less, AVLNode *&greater) const {
+	Probe<K> probe(*this, key, AVLTreeStats::Operation::SPLIT);
+	return this->splitNodes(node, probe, less, greater);
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::splitNodes(AVLNode *node, Probe<K> &probe, AVLNode *&less, AVLNode *&greater) const {
+	if (!node) {
+		less = nullptr;
+		greater = nullptr;
+		return nullptr;
+	}
+
+	AVLNode *left = node->left;
+	AVLNode *right = node->right;
+	int cmp = probe.compareTo(node);
+	if (cmp == 0) {
+		less = left;
+		greater = right;
+		node->left = nullptr;
+		node->right = nullptr;
+		node->update();
+		return node;
+	} else if (cmp < 0) {
+		AVLNode *equal = this->splitNodes(left, probe, less, greater);
+		greater = BasicAVLTree::joinNodes(greater, node, right);
+		return equal;
+	} else {
+		AVLNode *equal = this->splitNodes(right, probe, less, greater);
+		less = BasicAVLTree::joinNodes(left, node, less);
+		return equal;
+	}
+}
+
+/**
+ *	Recursive helper method for `unionWith()`, where both subtrees are made of
+ *	nodes of this tree. Each node of `theirs` splits `mine`, and the node of
+ *	`mine` with an equal key is destroyed.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::unionNodes(AVLNode *mine, AVLNode *theirs) {
+	if (!mine) {
+		return theirs;
+	} else if (!theirs) {
+		return mine;
+	}
+
+	AVLNode *theirLeft = theirs->left;
+	AVLNode *theirRight = theirs->right;
+	AVLNode *less;
+	AVLNode *greater;
+	AVLNode *equal = this->splitNodes(mine, theirs->key, less, greater);
+	if (equal) {this->destroyNode(equal);}
+
+	AVLNode *left = this->unionNodes(less, theirLeft);
+	AVLNode *right = this->unionNodes(greater, theirRight);
+	return BasicAVLTree::joinNodes(left, theirs, right);
+}
+
+/**
+ *	Recursive helper method for the parallel `unionWith()`. Splitting and
+ *	joining only relink the nodes of the two subtrees at hand, so disjoint
+ *	subtrees are merged at once. The nodes that are replaced are appended to
+ *	`replaced`, since only one thread at a time may use the node pool.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::unionParallel(
+	AVLNode *mine, AVLNode *theirs, std::vector<AVLNode *> &replaced, ThreadPool &pool, size_t cutoff
+) const {
+	if (!mine) {
+		return theirs;
+	} else if (!theirs) {
+		return mine;
+	}
+
+	size_t work = mine->count + theirs->count;
+	AVLNode *theirLeft = theirs->left;
+	AVLNode *theirRight = theirs->right;
+	AVLNode *less;
+	AVLNode *greater;
+	AVLNode *equal = this->splitNodes(mine, theirs->key, less, greater);
+	if (equal) {replaced.push_back(equal);}
+
+	AVLNode *left;
+	AVLNode *right;
+	if (work <= cutoff) {
+		left = this->unionParallel(less, theirLeft, replaced, pool, cutoff);
+		right = this->unionParallel(greater, theirRight, replaced, pool, cutoff);
+	} else {
+		std::vector<AVLNode *> rightReplaced;
+		pool.invoke(
+			[&] {left = this->unionParallel(less, theirLeft, replaced, pool, cutoff);},
+			[&] {right = this->unionParallel(greater, theirRight, rightReplaced, pool, cutoff);}
+		);
+		replaced.insert(replaced.end(), rightReplaced.begin(), rightReplaced.end());
+	}
+	return BasicAVLTree::joinNodes(left, theirs, right);
+}
+
+/** Recursive helper method for `intersect()`, which only reads the nodes of `theirs`. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::intersectNodes(AVLNode *mine, const AVLNode *theirs) {
+	if (!mine) {
+		return nullptr;
+	} else if (!theirs) {
+		this->discard(mine);
+		return nullptr;
+	}
+
+	AVLNode *less;
+	AVLNode *greater;
+	AVLNode *equal = this->splitNodes(mine, theirs->key, less, greater);
+	AVLNode *left = this->intersectNodes(less, theirs->left);
+	AVLNode *right = this->intersectNodes(greater, theirs->right);
+	if (equal) {
+		return BasicAVLTree::joinNodes(left, equal, right);
+	} else {
+		return BasicAVLTree::joinNodes(left, right);
+	}
+}
+
+/** Recursive helper method for `difference()`, which only reads the nodes of `theirs`. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::differenceNodes(AVLNode *mine, const AVLNode *theirs) {
+	if (!mine || !theirs) {
+		return mine;
+	}
+
+	AVLNode *less;
+	AVLNode *greater;
+	AVLNode *equal = this->splitNodes(mine, theirs->key, less, greater);
+	if (equal) {this->destroyNode(equal);}
+
+	AVLNode *left = this->differenceNodes(less, theirs->left);
+	AVLNode *right = this->differenceNodes(greater, theirs->right);
+	return BasicAVLTree::joinNodes(left, right);
+}
+
+/**
+ *	Takes over the nodes of the `other` tree, which is left empty, and returns
+ *	the root of those nodes. The slabs holding them are handed over as well,
+ *	unless the two trees use allocators that can't free each other's memory.
+ *	In that case, the nodes are copied instead. If this tree has a hash index,
+ *	the adopted nodes are added to it.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::adoptNodes(BasicAVLTree &other) {
+	AVLNode *adopted = nullptr;
+	if (std::allocator_traits<NodeAllocator>::is_always_equal::value || this->nodes.get_allocator() == other.nodes.get_allocator()) {
+		this->nodes.adopt(std::move(other.nodes));
+		adopted = std::exchange(other.root, nullptr);
+		other.length = 0;
+		if (other.hasHashIndex()) {other.rebuildIndex(true);}
+		other.renewCacheStamp();
+	} else {
+		this->insert(adopted, other.root);
+		other.release();
+	}
+	if (this->hasHashIndex()) {this->indexNodes(adopted);}
+	return adopted;
+}
+
+/** Recursive helper method that destroys every node of a subtree, handing their storage back to the node pool. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::discard(AVLNode *current) {
+	if (current) {
+		this->discard(current->left);
+		this->discard(current->right);
+		this->destroyNode(current);
+	}
+}
+
+/**
+ *	Inserts a pair whose key is constructed from `key` and whose value is
+ *	constructed from `args`, unless an equal key is already in the tree.
+ *	The key is constructed before the descent, so that it can be compared.
+ *
+ *	@return An iterator to the pair holding the key, and `true` if the pair was inserted.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename KeyArg, typename... Args>
+std::pair<typename BasicAVLTree<Key, Value, Compare, Allocator>::iterator, bool> BasicAVLTree<Key, Value, Compare, Allocator>::emplace(KeyArg &&key, Args &&...args) {
+	return this->try_emplace(KeyType(std::forward<KeyArg>(key)), std::forward<Args>(args)...);
+}
+
+/**
+ *	Inserts a pair of `key` and a value constructed from `args`, unless `key`
+ *	is already in the tree. In that case, the arguments are left untouched.
+ *
+ *	@return An iterator to the pair holding the key, and `true` if the pair was inserted.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename... Args>
+std::pair<typename BasicAVLTree<Key, Value, Compare, Allocator>::iterator, bool> BasicAVLTree<Key, Value, Compare, Allocator>::try_emplace(const KeyType &key, Args &&...args) {
+	Path path;
+	auto [node, inserted] = this->insertUnique(&path, key, std::forward<Args>(args)...);
+	return {iterator(this->root, path), inserted};
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename... Args>
+std::pair<typename BasicAVLTree<Key, Value, Compare, Allocator>::iterator, bool> BasicAVLTree<Key, Value, Compare, Allocator>::try_emplace(KeyType &&key, Args &&...args) {
+	Path path;
+	auto [node, inserted] = this->insertUnique(&path, std::move(key), std::forward<Args>(args)...);
+	return {iterator(this->root, path), inserted};
+}
+
+/**
+ *	Inserts a pair of `key` and `value`, or assigns `value` to the pair
+ *	already holding `key`.
+ *
+ *	@return An iterator to the pair holding the key, and `true` if the pair was inserted.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename M>
+std::pair<typename BasicAVLTree<Key, Value, Compare, Allocator>::iterator, bool> BasicAVLTree<Key, Value, Compare, Allocator>::insert_or_assign(const KeyType &key, M &&value) {
+	Path path;
+	auto [node, inserted] = this->insertUnique(&path, key, std::forward<M>(value));
+	if (!inserted) {node->value = std::forward<M>(value);}
+	return {iterator(this->root, path), inserted};
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename M>
+std::pair<typename BasicAVLTree<Key, Value, Compare, Allocator>::iterator, bool> BasicAVLTree<Key, Value, Compare, Allocator>::insert_or_assign(KeyType &&key, M &&value) {
+	Path path;
+	auto [node, inserted] = this->insertUnique(&path, std::move(key), std::forward<M>(value));
+	if (!inserted) {node->value = std::forward<M>(value);}
+	return {iterator(this->root, path), inserted};
+}
+
+/**
+ *	Returns the counters of the node pool backing this tree.
+ *	Once a tree reaches a steady state of insertions and removals, the number
+ *	of slab allocations no longer grows.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+const NodePoolStats & BasicAVLTree<Key, Value, Compare, Allocator>::allocationStats() const {
+	return this->nodes.stats();
+}
+
+/**
+ *	Returns a snapshot of the counters of the tree. While other threads read
+ *	the tree, each counter is exact, but the counters may be a few operations
+ *	apart from each other.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+AVLTreeStats BasicAVLTree<Key, Value, Compare, Allocator>::stats() const {
+	AVLTreeStats snapshot;
+	const NodePoolStats &pool = this->nodes.stats();
+	snapshot.nodesCreated = pool.nodesCreated;
+	snapshot.nodesDestroyed = pool.nodesDestroyed;
+	snapshot.slabAllocations = pool.slabAllocations;
+
+	if constexpr (KEEPS_STATS) {
+		snapshot.singleRotations = this->counters.singleRotations.load(std::memory_order_relaxed);
+		snapshot.doubleRotations = this->counters.doubleRotations.load(std::memory_order_relaxed);
+		snapshot.comparisons = this->counters.comparisons.load(std::memory_order_relaxed);
+		snapshot.longComparisons = this->counters.longComparisons.load(std::memory_order_relaxed);
+		for (size_t op = 0; op < AVLTreeStats::OPERATIONS; ++op) {
+			for (size_t d = 0; d <= AVLTreeStats::MAX_PATH_LENGTH; ++d) {
+				snapshot.pathLengths[op][d] = this->counters.pathLengths[op][d].load(std::memory_order_relaxed);
+			}
+		}
+	}
+	return snapshot;
+}
+
+/** Starts all counters of `stats()` over, including those of the node pool. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::resetStats() {
+	this->nodes.resetStats();
+
+	if constexpr (KEEPS_STATS) {
+		this->counters.singleRotations.store(0, std::memory_order_relaxed);
+		this->counters.doubleRotations.store(0, std::memory_order_relaxed);
+		this->counters.comparisons.store(0, std::memory_order_relaxed);
+		this->counters.longComparisons.store(0, std::memory_order_relaxed);
+		for (auto &lengths : this->counters.pathLengths) {
+			for (std::atomic<size_t> &length : lengths) {length.store(0, std::memory_order_relaxed);}
+		}
+	}
+}
+
+/** Counts the rotations of one rebalancing, as returned by `rebalance()`. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::countRotations(size_t rotations) {
+	if constexpr (KEEPS_STATS) {
+		if (rotations == 1) {
+			this->counters.singleRotations.fetch_add(1, std::memory_order_relaxed);
+		} else if (rotations == 2) {
+			this->counters.doubleRotations.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+}
+
+/** Counts one descent, which compared its key with `compared` nodes, `longCompared` of them past the prefixes. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::countDescent(AVLTreeStats::Operation operation, size_t compared, size_t longCompared) const {
+	if constexpr (KEEPS_STATS) {
+		size_t length = std::min(compared, AVLTreeStats::MAX_PATH_LENGTH);
+		this->counters.comparisons.fetch_add(compared, std::memory_order_relaxed);
+		if (longCompared) {this->counters.longComparisons.fetch_add(longCompared, std::memory_order_relaxed);}
+		this->counters.pathLengths[static_cast<size_t>(operation)][length].fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+/**
+ *	Turns the hash index of the tree on or off. Turning it on indexes every
+ *	node the tree holds, and turning it off frees the index.
+ *
+ *	Expected time complexity is `O(n)`, or `O(1)` if the index already is in that state.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::setHashIndex(bool enabled) requires HAS_HASH_INDEX {
+	if (enabled != this->index.isEnabled()) {
+		this->rebuildIndex(enabled);
+	}
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::hasHashIndex() const {
+	if constexpr (HAS_HASH_INDEX) {
+		return this->index.isEnabled();
+	} else {
+		return false;
+	}
+}
+
+/** Returns the number of bytes held by the hash index, on top of `memoryUsage()`. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::hashIndexMemory() const {
+	if constexpr (HAS_HASH_INDEX) {
+		return this->index.memoryUsage();
+	} else {
+		return 0;
+	}
+}
+
+/** String keys are hashed as views, so that any string-like key finds its node. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::hashOf(const K &key) {
+	if constexpr (USES_STRING_ORDER) {
+		return std::hash<std::string_view>{}(std::string_view(key));
+	} else {
+		return std::hash<Key>{}(key);
+	}
+}
+
+/** Creates a node in the node pool, and adds it to the hash index if the tree has one. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename... Args>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::createNode(Args &&...args) {
+	AVLNode *node = this->nodes.create(std::forward<Args>(args)...);
+	if constexpr (HAS_HASH_INDEX) {
+		if (this->index.isEnabled()) {this->index.insert(BasicAVLTree::hashOf(node->key), node);}
+	}
+	return node;
+}
+
+/** Removes a node from the hash index if the tree has one, drops the cached pointers to it, and destroys it. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::destroyNode(AVLNode *node) {
+	if constexpr (HAS_HASH_INDEX) {
+		if (this->index.isEnabled()) {this->index.erase(BasicAVLTree::hashOf(node->key), node);}
+	}
+	this->uncacheNode(node);
+	this->nodes.destroy(node);
+}
+
+/**
+ *	Indexes every node of the tree anew if `enabled` is set, or frees the index
+ *	otherwise. Operations that take nodes over in bulk call this instead of
+ *	indexing them one at a time.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::rebuildIndex(bool enabled) {
+	if constexpr (HAS_HASH_INDEX) {
+		if (enabled) {
+			this->index.reset(this->length);
+			this->indexNodes(this->root);
+		} else {
+			this->index.disable();
+		}
+	}
+}
+
+/** Recursive helper method that adds every node of a subtree to the hash index. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::indexNodes(AVLNode *current) {
+	if constexpr (HAS_HASH_INDEX) {
+		if (current) {
+			this->index.insert(BasicAVLTree::hashOf(current->key), current);
+			this->indexNodes(current->left);
+			this->indexNodes(current->right);
+		}
+	}
+}
+
+/** Recursive helper method that removes every node of a subtree from the hash index. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::unindexNodes(const AVLNode *current) {
+	if constexpr (HAS_HASH_INDEX) {
+		if (current) {
+			this->index.erase(BasicAVLTree::hashOf(current->key), current);
+			this->unindexNodes(current->left);
+			this->unindexNodes(current->right);
+		}
+	}
+}
+
+/**
+ *	Turns the lookup cache of the tree on or off. The cache itself belongs
+ *	to each thread, so this only decides whether lookups in this tree use it.
+ *
+ *	Expected time complexity is `O(1)`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::setLookupCache(bool enabled) requires HAS_HASH_INDEX {
+	if (enabled != (this->cacheStamp != 0)) {
+		this->cacheStamp = enabled ? BasicAVLTree::newCacheStamp() : 0;
+		this->cacheOwner = 0;
+	}
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::hasLookupCache() const {
+	return this->cacheStamp != 0;
+}
+
+/** Returns the counters of the lookup cache of the calling thread, which `hitRate()` sizes the cache by. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+LookupCacheStats BasicAVLTree<Key, Value, Compare, Allocator>::lookupCacheStats() {
+	return BasicAVLTree::lookupCache().stats;
+}
+
+/** Starts the counters of the lookup cache of the calling thread over. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::resetLookupCacheStats() {
+	BasicAVLTree::lookupCache().stats = LookupCacheStats();
+}
+
+/** The lookup cache of the calling thread, shared by all trees of this type. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::LookupCache & BasicAVLTree<Key, Value, Compare, Allocator>::lookupCache() {
+	static thread_local LookupCache cache;
+	return cache;
+}
+
+/** Returns a stamp that no tree of this type had before. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+uint64_t BasicAVLTree<Key, Value, Compare, Allocator>::newCacheStamp() {
+	static std::atomic<uint64_t> lastStamp{0};
+	return lastStamp.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+/** Drops every cached pointer to the nodes of this tree, if it has a lookup cache. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::renewCacheStamp() {
+	if (this->cacheStamp) {
+		this->cacheStamp = BasicAVLTree::newCacheStamp();
+		this->cacheOwner = 0;
+	}
+}
+
+/**
+ *	Drops the cached pointers to a node that is about to be destroyed.
+ *
+ *	A node is only ever cached in the slot its key hashes to. If only the
+ *	calling thread has cached nodes of this tree, clearing that one slot is
+ *	enough. The caches of other threads can't be reached from here, so if they
+ *	hold nodes of this tree too, the tree takes a new stamp instead.
+ *
+ *	The fingers need no clearing, since a finger is only followed through nodes
+ *	that are still linked to the root.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::uncacheNode(const AVLNode *node) {
+	if (!this->cacheOwner) {
+		return;
+	}
+
+	LookupCache &cache = BasicAVLTree::lookupCache();
+	if (this->cacheOwner == reinterpret_cast<uintptr_t>(&cache)) {
+		CachedNode &slot = cache.nodes[BasicAVLTree::hashOf(node->key) & (LOOKUP_CACHE_SLOTS - 1)];
+		if (slot.stamp == this->cacheStamp && slot.node == node) {slot.stamp = 0;}
+	} else {
+		this->renewCacheStamp();
+	}
+}
+
+/**
+ *	Records that the `cache` of the calling thread holds nodes of this tree.
+ *	Concurrent readers may cache nodes at once, so the owner is only changed
+ *	through an atomic reference, and only until it is shared.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::claimCache(const LookupCache &cache) const {
+	std::atomic_ref<uintptr_t> owner(this->cacheOwner);
+	uintptr_t current = owner.load(std::memory_order_relaxed);
+	uintptr_t own = reinterpret_cast<uintptr_t>(&cache);
+	if (current == own || current == SHARED_CACHE) {
+		return;
+	}
+	if (!current && owner.compare_exchange_strong(current, own, std::memory_order_relaxed)) {
+		return;
+	}
+	owner.store(SHARED_CACHE, std::memory_order_relaxed);
+}
+
+/**
+ *	Looks up `key` in the cache of the calling thread, whose slot is picked
+ *	by the hash of the key, and searches the tree if the slot holds no node
+ *	of this tree with that key. A node that the search finds takes the slot.
+ *
+ *	A cached node can't have been destroyed, since destroying it clears its
+ *	slot, or gives the tree a new stamp if other threads cache its nodes too.
+ *	An insertion only adds nodes, so it leaves the cache alone.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::findCached(const K &key) const {
+	LookupCache &cache = BasicAVLTree::lookupCache();
+	size_t hash = BasicAVLTree::hashOf(key);
+	CachedNode &slot = cache.nodes[hash & (LOOKUP_CACHE_SLOTS - 1)];
+	if (slot.stamp == this->cacheStamp && slot.hash == hash && this->compareKeys(slot.node->key, key) == 0) {
+		++cache.stats.hits;
+		return slot.node;
+	}
+
+	++cache.stats.misses;
+	AVLNode *node = this->fingerSearch(cache, key);
+	if (node) {
+		slot = CachedNode{this->cacheStamp, hash, node};
+		this->claimCache(cache);
+	}
+	return node;
+}
+
+/**
+ *	Searches for `key` from the deepest node of the finger whose subtree must
+ *	hold it, and leaves the path of this search as the finger.
+ *
+ *	The finger is the path of the previous search in this tree. Insertions may
+ *	have rotated its nodes since, so it is only followed from the root for as
+ *	long as each node is still a child of the one before. The subtree of a node
+ *	on the path holds the keys between its closest ancestors on either side,
+ *	which are those where the path last turned right and left above it.
+ *
+ *	Expected time complexity is `O(log(n))`, and `O(log(d))` comparisons for a
+ *	key `d` positions away from the previous one in a well balanced tree.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::AVLNode * BasicAVLTree<Key, Value, Compare, Allocator>::fingerSearch(LookupCache &cache, const K &key) const {
+	size_t depth = 0;
+	AVLNode *current = this->root;
+	if (cache.fingerStamp == this->cacheStamp && cache.fingerDepth && cache.finger[0] == this->root) {
+		/* Positions on the finger of the closest ancestors below and above each node, or `NONE`. */
+		constexpr size_t NONE = Path::MAX_DEPTH;
+		size_t low[Path::MAX_DEPTH];
+		size_t high[Path::MAX_DEPTH];
+		low[0] = high[0] = NONE;
+		for (depth = 1; depth < cache.fingerDepth; ++depth) {
+			const AVLNode *parent = cache.finger[depth - 1];
+			if (cache.finger[depth] == parent->left) {
+				low[depth] = low[depth - 1];
+				high[depth] = depth - 1;
+			} else if (cache.finger[depth] == parent->right) {
+				low[depth] = depth - 1;
+				high[depth] = high[depth - 1];
+			} else {
+				break;
+			}
+		}
+
+		/* Climbs past every ancestor that bounds the key out, comparing with each bound that holds once. */
+		size_t lowHolds = NONE;
+		size_t highHolds = NONE;
+		while (depth > 1) {
+			size_t i = depth - 1;
+			if (low[i] != NONE && low[i] != lowHolds) {
+				if (this->compareKeys(key, cache.finger[low[i]]->key) <= 0) {
+					depth = low[i] + 1;
+					continue;
+				}
+				lowHolds = low[i];
+			}
+			if (high[i] != NONE && high[i] != highHolds) {
+				if (this->compareKeys(key, cache.finger[high[i]]->key) >= 0) {
+					depth = high[i] + 1;
+					continue;
+				}
+				highHolds = high[i];
+			}
+			break;
+		}
+
+		current = cache.finger[--depth];
+		if (depth) {++cache.stats.fingerStarts;}
+	}
+
+	cache.fingerStamp = this->cacheStamp;
+	Probe<K> probe(*this, key);
+	while (current) {
+		cache.finger[depth++] = current;
+		int cmp = probe.compareTo(current);
+		if (cmp < 0) {
+			current = current->left;
+		} else if (cmp > 0) {
+			current = current->right;
+		} else {
+			break;
+		}
+	}
+	cache.fingerDepth = depth;
+	return current;
+}
+
+/** Returns a copy of the comparator ordering the keys. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+Compare BasicAVLTree<Key, Value, Compare, Allocator>::key_comp() const {
+	return this->comp;
+}
+
+/** Returns a copy of the allocator that the node pool draws its slabs from. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+Allocator BasicAVLTree<Key, Value, Compare, Allocator>::get_allocator() const {
+	return Allocator(this->nodes.get_allocator());
+}
+
+/**
+ *	Copies the tree into a `BasicFrozenAVLTree`, which can't be changed, but
+ *	which answers lookups and range scans faster than the tree. The tree
+ *	itself is left as it was, so it can keep taking writes and be frozen again.
+ *
+ *	Expected time complexity is `O(n)`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+BasicFrozenAVLTree<Key, Value, Compare> BasicAVLTree<Key, Value, Compare, Allocator>::freeze() const {
+	using Frozen = BasicFrozenAVLTree<Key, Value, Compare>;
+
+	std::vector<typename Frozen::Entry> entries;
+	entries.reserve(this->length);
+	for (const Entry &entry : *this) {entries.push_back({entry.key, entry.value});}
+	return Frozen(std::move(entries), this->comp);
+}
+
+/**
+ *	Writes the tree to `path` in the binary snapshot format of `AVLTreeSnapshot`,
+ *	which `load()` reads back and `BasicMappedAVLTree` serves without loading.
+ *	The file is replaced as a whole, so no reader ever sees a partial snapshot.
+ *
+ *	@return `true` if the snapshot was written, or `false` if it was not, in
+ *	which case any file at `path` is left as it was.
+ *
+ *	Expected time complexity is `O(n + k)` for `n` keys of `k` bytes in total.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::save(const std::string &path) const requires HAS_SNAPSHOTS {
+	uint64_t keyBytes = 0;
+	for (const Entry &entry : *this) {keyBytes += entry.key.size();}
+
+	AVLTreeSnapshot::Layout layout = AVLTreeSnapshot::layoutOf(this->length, keyBytes, sizeof(ValueType));
+	std::vector<uint64_t> words(layout.end / sizeof(uint64_t));
+	char *file = reinterpret_cast<char *>(words.data());
+	uint64_t *offsets = words.data() + layout.offsets / sizeof(uint64_t);
+
+	size_t i = 0;
+	uint64_t offset = 0;
+	for (const Entry &entry : *this) {
+		offsets[i] = offset;
+		std::memcpy(file + layout.values + i * sizeof(ValueType), &entry.value, sizeof(ValueType));
+		std::memcpy(file + layout.keys + offset, entry.key.data(), entry.key.size());
+		offset += entry.key.size();
+		++i;
+	}
+	offsets[i] = offset;
+
+	AVLTreeSnapshot::Header header{};
+	std::memcpy(header.magic, AVLTreeSnapshot::MAGIC, sizeof(header.magic));
+	header.version = AVLTreeSnapshot::VERSION;
+	header.valueSize = sizeof(ValueType);
+	header.count = this->length;
+	header.keyBytes = keyBytes;
+	header.checksum = AVLTreeSnapshot::checksum(file + layout.offsets, layout.end - layout.offsets);
+	std::memcpy(file, &header, sizeof(header));
+
+	return AVLTreeSnapshot::writeFile(path, file, layout.end);
+}
+
+/**
+ *	Replaces the contents of the tree with a snapshot written by `save()`.
+ *	The keys of a snapshot are already sorted, so the tree is built in one
+ *	pass, in the same way as a sorted `bulkLoad()`.
+ *
+ *	@return `true` if the snapshot was loaded, or `false` if it could not be
+ *	read or was rejected by `BasicMappedAVLTree::open()`, in which case the
+ *	tree is left as it was.
+ *
+ *	Expected time complexity is `O(n + k)` for `n` keys of `k` bytes in total.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::load(const std::string &path) requires HAS_SNAPSHOTS {
+	BasicMappedAVLTree<ValueType> snapshot;
+	if (!snapshot.open(path)) {
+		return false;
+	}
+
+	SortedRun run{snapshot.size(), snapshot.size()};
+	return this->loadSorted(snapshot.begin(), snapshot.end(), run, DuplicatePolicy::REJECT);
+}
+
+/**
+ *	Returns the height of the tree.
+ *	If the tree is empty, its height is `-1`.
+ *
+ *	Expected time complexity is `O(1)`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::getHeight() const {
+	if (this->root) {
+		return this->root->height;
+	} else {
+		return -1;
+	}
+}
+
+/**
+ *	Recursive helper to traverse the nodes of the tree at the proper depth.
+ *	This uses the right child first in-order traversal in the tree.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::printDepth(std::ostream &os, const AVLNode *node, const size_t depth) {
+	if (node) {
+		BasicAVLTree::printDepth(os, node->right, depth + 1);
+		os << std::string(2 * depth, ' ') << node << "\n";
+		BasicAVLTree::printDepth(os, node->left, depth + 1);
+	}
+	return;
+}
+
+/**
+ *	Returns the value associated with the specified `key` if it exists.
+ *	Otherwise, if that key doesn't exist in the tree, `std::nullopt` is returned.
+ *
+ *	Expected time complexity is `O(log(n))`, or `O(1)` with a hash index.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+std::optional<typename BasicAVLTree<Key, Value, Compare, Allocator>::ValueType> BasicAVLTree<Key, Value, Compare, Allocator>::get(const KeyType &key) const {
+	const AVLNode *node = this->findNode(key);
+	if (node) {
+		return std::optional{node->value};
+	} else {
+		return std::nullopt;
+	}
+}
+
+/**
+ *	Same as `get()`, for any `key` the transparent comparator can compare
+ *	with the keys of the tree.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K> requires TransparentCompare<Compare>
+std::optional<typename BasicAVLTree<Key, Value, Compare, Allocator>::ValueType> BasicAVLTree<Key, Value, Compare, Allocator>::get(const K &key) const {
+	const AVLNode *node = this->findNode(key);
+	if (node) {
+		return std::optional{node->value};
+	} else {
+		return std::nullopt;
+	}
+}
+
+/**
+ *	Looks up every key of `keys` at once, and stores the value of `keys[i]` in
+ *	`values[i]`, or `std::nullopt` if that key doesn't exist in the tree.
+ *
+ *	The descents of several keys are interleaved, so that their cache misses
+ *	overlap, which is faster than calling `get()` for each key on a tree that
+ *	doesn't fit in the cache. Sorting the keys first with `sortFirst` helps
+ *	further when the batch is large or its keys are close to each other.
+ *
+ *	@return `false`, without looking anything up, if `values` is shorter than `keys`.
+ *
+ *	Expected time complexity is `O(k * log(n))` for `k` keys, plus `O(k * log(k))` if sorted first.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::getBatch(
+	std::span<const KeyType> keys, std::span<std::optional<ValueType>> values, bool sortFirst
+) const {
+	if (values.size() < keys.size()) {return false;}
+
+	this->findBatch(keys, sortFirst, [&](size_t i, const AVLNode *node) {
+		if (node) {
+			values[i] = node->value;
+		} else {
+			values[i] = std::nullopt;
+		}
+	});
+	return true;
+}
+
+/**
+ *	Same as `getBatch()`, but only stores in `found[i]` whether `keys[i]` is in the tree.
+ *
+ *	@return `false`, without looking anything up, if `found` is shorter than `keys`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicAVLTree<Key, Value, Compare, Allocator>::containsBatch(
+	std::span<const KeyType> keys, std::span<bool> found, bool sortFirst
+) const {
+	if (found.size() < keys.size()) {return false;}
+
+	this->findBatch(keys, sortFirst, [&](size_t i, const AVLNode *node) {
+		found[i] = (node != nullptr);
+	});
+	return true;
+}
+
+/**
+ *	Returns the value associated with the specified `key`.
+ *	But the value of that key can also be updated.
+ *
+ *	This method may be ill-formed if a key does not exist.
+ *
+ *	Expected time complexity is `O(log(n))`, or `O(1)` with a hash index if `key` is in the tree.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::ValueType & BasicAVLTree<Key, Value, Compare, Allocator>::operator[](const KeyType &key) {
+	return this->findNode(key)->value;
+}
+
+/**
+ *	Returns an iterator to the smallest key in the tree.
+ *	If the tree is empty, this is the same as `end()`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::iterator BasicAVLTree<Key, Value, Compare, Allocator>::begin() {
+	Path path;
+	BasicAVLTree::descendMin(path, this->root);
+	return iterator(this->root, path);
+}
+
+/** Returns the iterator past the largest key in the tree, which holds an empty path. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::iterator BasicAVLTree<Key, Value, Compare, Allocator>::end() {
+	return iterator(this->root, Path());
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::const_iterator BasicAVLTree<Key, Value, Compare, Allocator>::begin() const {
+	return const_cast<BasicAVLTree *>(this)->begin();
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::const_iterator BasicAVLTree<Key, Value, Compare, Allocator>::end() const {
+	return const_cast<BasicAVLTree *>(this)->end();
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::const_iterator BasicAVLTree<Key, Value, Compare, Allocator>::cbegin() const {return this->begin();}
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::const_iterator BasicAVLTree<Key, Value, Compare, Allocator>::cend() const {return this->end();}
+
+/**
+ *	Returns an iterator to the pair holding `key`, or `end()` if the key isn't in the tree.
+ *	With a hash index, a key that isn't in the tree is turned away by the index.
+ *
+ *	Expected time complexity is `O(log(n))`, or `O(1)` for a miss with a hash index.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::iterator BasicAVLTree<Key, Value, Compare, Allocator>::find(const KeyType &key) {
+	return iterator(this->root, this->findPath(key));
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::const_iterator BasicAVLTree<Key, Value, Compare, Allocator>::find(const KeyType &key) const {
+	return const_iterator(this->root, this->findPath(key));
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K> requires TransparentCompare<Compare>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::iterator BasicAVLTree<Key, Value, Compare, Allocator>::find(const K &key) {
+	return iterator(this->root, this->findPath(key));
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K> requires TransparentCompare<Compare>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::const_iterator BasicAVLTree<Key, Value, Compare, Allocator>::find(const K &key) const {
+	return const_iterator(this->root, this->findPath(key));
+}
+
+/**
+ *	Returns an iterator to the first pair whose key is not smaller than `key`.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::iterator BasicAVLTree<Key, Value, Compare, Allocator>::lower_bound(const KeyType &key) {
+	return iterator(this->root, this->pathToBound(key, false));
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::const_iterator BasicAVLTree<Key, Value, Compare, Allocator>::lower_bound(const KeyType &key) const {
+	return const_iterator(this->root, this->pathToBound(key, false));
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K> requires TransparentCompare<Compare>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::iterator BasicAVLTree<Key, Value, Compare, Allocator>::lower_bound(const K &key) {
+	return iterator(this->root, this->pathToBound(key, false));
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K> requires TransparentCompare<Compare>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::const_iterator BasicAVLTree<Key, Value, Compare, Allocator>::lower_bound(const K &key) const {
+	return const_iterator(this->root, this->pathToBound(key, false));
+}
+
+/**
+ *	Returns an iterator to the first pair whose key is greater than `key`.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::iterator BasicAVLTree<Key, Value, Compare, Allocator>::upper_bound(const KeyType &key) {
+	return iterator(this->root, this->pathToBound(key, true));
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::const_iterator BasicAVLTree<Key, Value, Compare, Allocator>::upper_bound(const KeyType &key) const {
+	return const_iterator(this->root, this->pathToBound(key, true));
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K> requires TransparentCompare<Compare>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::iterator BasicAVLTree<Key, Value, Compare, Allocator>::upper_bound(const K &key) {
+	return iterator(this->root, this->pathToBound(key, true));
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K> requires TransparentCompare<Compare>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::const_iterator BasicAVLTree<Key, Value, Compare, Allocator>::upper_bound(const K &key) const {
+	return const_iterator(this->root, this->pathToBound(key, true));
+}
+
+/** Extends the path from `current` down to the smallest key of its subtree. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::descendMin(Path &path, AVLNode *current) {
+	while (current) {
+		path.push(current);
+		current = current->left;
+	}
+}
+
+/** Extends the path from `current` down to the largest key of its subtree. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::descendMax(Path &path, AVLNode *current) {
+	while (current) {
+		path.push(current);
+		current = current->right;
+	}
+}
+
+/**
+ *	Moves the path to the in-order successor of its node.
+ *	Either the successor is the smallest key of the right subtree, or it is the
+ *	closest ancestor whose left subtree holds the current node.
+ *	Past the largest key, the path becomes empty.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::next(Path &path) {
+	AVLNode *current = path.top();
+	if (current->right) {
+		BasicAVLTree::descendMin(path, current->right);
+	} else {
+		path.pop();
+		while (!path.empty() && (path.top()->right == current)) {
+			current = path.top();
+			path.pop();
+		}
+	}
+}
+
+/**
+ *	Moves the path to the in-order predecessor of its node, which mirrors `next()`.
+ *	An empty path moves to the largest key of the tree.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::prev(AVLNode *root, Path &path) {
+	if (path.empty()) {
+		BasicAVLTree::descendMax(path, root);
+		return;
+	}
+
+	AVLNode *current = path.top();
+	if (current->left) {
+		BasicAVLTree::descendMax(path, current->left);
+	} else {
+		path.pop();
+		while (!path.empty() && (path.top()->left == current)) {
+			current = path.top();
+			path.pop();
+		}
+	}
+}
+
+/** Returns the path to the node holding `key`, or an empty path if there is no such node. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::Path BasicAVLTree<Key, Value, Compare, Allocator>::pathTo(const K &key) const {
+	Path path;
+	Probe<K> probe(*this, key);
+	AVLNode *current = this->root;
+	while (current) {
+		path.push(current);
+		int cmp = probe.compareTo(current);
+		if (cmp < 0) {
+			current = current->left;
+		} else if (cmp > 0) {
+			current = current->right;
+		} else {
+			return path;
+		}
+	}
+	path.clear();
+	return path;
+}
+
+/**
+ *	Returns the path to the node holding `key`, like `pathTo()`, but asks the
+ *	hash index first, if the tree has one. A key the index doesn't hold gets an
+ *	empty path without a descent. A key it does hold is still descended to,
+ *	since nodes don't link to their parents and an iterator needs the path.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::Path BasicAVLTree<Key, Value, Compare, Allocator>::findPath(const K &key) const {
+	if constexpr (HAS_HASH_INDEX && HASHES_LIKE_KEY<K>) {
+		if (this->index.isEnabled() && !this->findNode(key)) {return Path();}
+	}
+	return this->pathTo(key);
+}
+
+/**
+ *	Returns the path to the first node whose key is not smaller than `key`, or
+ *	greater than `key` if `upper` is set. Such a node is the last node on the
+ *	way down where the descent turned left, so the path is cut back to it.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename K>
+typename BasicAVLTree<Key, Value, Compare, Allocator>::Path BasicAVLTree<Key, Value, Compare, Allocator>::pathToBound(const K &key, bool upper) const {
+	Path path;
+	Probe<K> probe(*this, key);
+	size_t boundDepth = 0;
+	AVLNode *current = this->root;
+	while (current) {
+		path.push(current);
+		int cmp = probe.compareTo(current);
+		if (upper ? (cmp < 0) : (cmp <= 0)) {
+			boundDepth = path.size();
+			current = current->left;
+		} else {
+			current = current->right;
+		}
+	}
+	path.truncate(boundDepth);
+	return path;
+}
+
+/**
+ *	Returns a vector containing all the keys in the tree.
+ *	The vector has the same size as the tree's size.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+std::vector<typename BasicAVLTree<Key, Value, Compare, Allocator>::KeyType> BasicAVLTree<Key, Value, Compare, Allocator>::keys() const {
+	std::vector<KeyType> keyList;
+	this->grabKey(keyList, this->root);
+	return keyList;
+}
+
+/**
+ *	Recursive helper to traverse the nodes of the tree to grab a key from a node
+ *	and insert that key in a vector called the key list.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::grabKey(std::vector<BasicAVLTree::KeyType> &keyList, const AVLNode *current) const {
+	if (current) {
+		this->grabKey(keyList, current->left);
+		keyList.push_back(current->key);
+		this->grabKey(keyList, current->right);
+	}
+	return;
+}
+
+/**
+ *	Returns the number of keys in the tree that are smaller than `key`.
+ *	If `key` is in the tree, this is the position of that key in `keys()`.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::rank(const KeyType &key) const {
+	return this->countBelow(key, false);
+}
+
+/**
+ *	Counts the keys that are smaller than `key`, or also equal to it if `inclusive`.
+ *	Whenever the descent goes right, the node and its whole left subtree are below `key`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::countBelow(const KeyType &key, bool inclusive) const {
+	size_t below = 0;
+	Probe<KeyType> probe(*this, key);
+	const AVLNode *current = this->root;
+	while (current) {
+		int cmp = probe.compareTo(current);
+		if (cmp < 0 || (cmp == 0 && !inclusive)) {
+			current = current->left;
+		} else {
+			below += (current->left ? current->left->count : 0) + 1;
+			current = current->right;
+		}
+	}
+	return below;
+}
+
+/**
+ *	Returns the `k`-th smallest key in the tree, counting from `0`.
+ *	If `k` is not less than the size of the tree, `std::nullopt` is returned.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+std::optional<typename BasicAVLTree<Key, Value, Compare, Allocator>::KeyType> BasicAVLTree<Key, Value, Compare, Allocator>::select(size_t k) const {
+	const AVLNode *current = this->root;
+	while (current) {
+		size_t leftCount = current->left ? current->left->count : 0;
+		if (k < leftCount) {
+			current = current->left;
+		} else if (k > leftCount) {
+			k -= leftCount + 1;
+			current = current->right;
+		} else {
+			return std::optional{current->key};
+		}
+	}
+	return std::nullopt;
+}
+
+/**
+ *	Returns the number of keys in the range bounded by `low` and `high`,
+ *	without visiting the keys in that range.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicAVLTree<Key, Value, Compare, Allocator>::countRange(const KeyType &low, const KeyType &high, Bound lowBound, Bound highBound) const {
+	size_t upper = (highBound == Bound::UNBOUNDED) ? this->length :
+		this->countBelow(high, highBound == Bound::INCLUSIVE);
+	size_t lower = (lowBound == Bound::UNBOUNDED) ? 0 :
+		this->countBelow(low, lowBound == Bound::EXCLUSIVE);
+	return (upper > lower) ? (upper - lower) : 0;
+}
+
+/**
+ *	Returns at most `limit` keys in ascending order, starting from the key at
+ *	position `offset`. Pages are the same as slices of `keys()`.
+ *
+ *	Expected time complexity is `O(log(n) + limit)`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+std::vector<typename BasicAVLTree<Key, Value, Compare, Allocator>::KeyType> BasicAVLTree<Key, Value, Compare, Allocator>::keysPage(size_t offset, size_t limit) const {
+	std::vector<KeyType> keyList;
+	if (offset < this->length) {
+		keyList.reserve(std::min(limit, this->length - offset));
+		this->grabKey(keyList, this->root, offset, limit);
+	}
+	return keyList;
+}
+
+/**
+ *	Recursive helper for `keysPage()`. Subtrees that lie entirely before the
+ *	page are skipped using their sizes, and the traversal stops once the page is full.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicAVLTree<Key, Value, Compare, Allocator>::grabKey(std::vector<BasicAVLTree::KeyType> &keyList, const AVLNode *current, size_t offset, size_t limit) const {
+	if (current && (keyList.size() < limit)) {
+		size_t leftCount = current->left ? current->left->count : 0;
+		if (offset < leftCount) {
+			this->grabKey(keyList, current->left, offset, limit);
+		} if ((offset <= leftCount) && (keyList.size() < limit)) {
+			keyList.push_back(current->key);
+		} if (keyList.size() < limit) {
+			this->grabKey(keyList, current->right, (offset > leftCount) ? (offset - leftCount - 1) : 0, limit);
+		}
+	}
+	return;
+}
+
+/**
+ *	Returns a vector of all unique values that correspond to the keys that are in a range
+ *	bounded by `low` and `high`.
+ *
+ *	Expected time complexity is `O(log(n) + k)` for `k` keys in the range.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+std::vector<typename BasicAVLTree<Key, Value, Compare, Allocator>::ValueType> BasicAVLTree<Key, Value, Compare, Allocator>::findRange(const KeyType &low, const KeyType &high) const {
+	std::vector<ValueType> valueList;
+	this->findRange(low, high, std::back_inserter(valueList), Bound::INCLUSIVE, Bound::INCLUSIVE, true);
+	return valueList;
+}
+
+/**
+ *	Calls `visit(key, value)` on every key-value pair whose key is between `low`
+ *	and `high`, in ascending order of the keys. Each bound may include or exclude
+ *	its key, or be left unbounded.
+ *
+ *	Only subtrees that can hold keys in the range are visited, and nothing is
+ *	allocated.
+ *
+ *	Expected time complexity is `O(log(n) + k)` for `k` visited pairs.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename Visitor>
+void BasicAVLTree<Key, Value, Compare, Allocator>::visitRange(
+	const KeyType &low, const KeyType &high, Visitor &&visit,
+	Bound lowBound, Bound highBound
+) const {
+	std::optional<Probe<KeyType>> lowProbe;
+	std::optional<Probe<KeyType>> highProbe;
+	if (lowBound != Bound::UNBOUNDED) {lowProbe.emplace(*this, low);}
+	if (highBound != Bound::UNBOUNDED) {highProbe.emplace(*this, high);}
+	this->visitRange(
+		this->root, lowProbe ? &*lowProbe : nullptr, highProbe ? &*highProbe : nullptr,
+		lowBound, highBound, visit
+	);
+}
+
+/**
+ *	Writes the value of every key-value pair whose key is in the range to `out`,
+ *	in ascending order of the keys, and returns the advanced output iterator.
+ *
+ *	If `unique` is set, a value is only written the first time it is found,
+ *	which is tracked with a hash set. Values without a `std::hash` are never
+ *	filtered.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename OutputIt>
+OutputIt BasicAVLTree<Key, Value, Compare, Allocator>::findRange(
+	const KeyType &low, const KeyType &high, OutputIt out,
+	Bound lowBound, Bound highBound, bool unique
+) const {
+	if constexpr (requires (const ValueType &value) {std::hash<ValueType>{}(value);}) {
+		if (unique) {
+			std::unordered_set<ValueType> seen;
+			this->visitRange(low, high, [&](const KeyType &, const ValueType &value) {
+				if (seen.insert(value).second) {*out++ = value;}
+			}, lowBound, highBound);
+			return out;
+		}
+	} else {
+		static_cast<void>(unique);
+	}
+
+	this->visitRange(low, high, [&](const KeyType &, const ValueType &value) {
+		*out++ = value;
+	}, lowBound, highBound);
+	return out;
+}
+
+/**
+ *	Recursive helper to visit the nodes in the range.
+ *
+ *	The left subtree only holds keys smaller than the current key, so it is
+ *	skipped once the current key is at or below the lower bound. Likewise, the
+ *	right subtree is skipped once the current key is at or above the upper bound.
+ *
+ *	A bound whose probe is `nullptr` is known to hold for the whole subtree:
+ *	every key right of a key above the lower bound is above it as well, and
+ *	the same goes for the upper bound on the left. So each probe is only
+ *	compared with the nodes on the path to its bound, as one descent.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename Visitor>
+void BasicAVLTree<Key, Value, Compare, Allocator>::visitRange(
+	const AVLNode *current, Probe<KeyType> *low, Probe<KeyType> *high,
+	Bound lowBound, Bound highBound, Visitor &visit
+) const {
+	if (current) {
+		int lowCmp = low ? low->compareTo(current) : -1;
+		int highCmp = high ? high->compareTo(current) : 1;
+
+		bool aboveLow = lowCmp < 0;
+		bool belowHigh = highCmp > 0;
+		bool inLow = aboveLow || ((lowBound == Bound::INCLUSIVE) && lowCmp == 0);
+		bool inHigh = belowHigh || ((highBound == Bound::INCLUSIVE) && highCmp == 0);
+
+		if (aboveLow) {
+			this->visitRange(current->left, low, belowHigh ? nullptr : high, lowBound, highBound, visit);
+		} if (inLow && inHigh) {
+			visit(current->key, current->value);
+		} if (belowHigh) {
+			this->visitRange(current->right, aboveLow ? nullptr : low, high, lowBound, highBound, visit);
+		}
+	}
+	return;
+}
@@ -0,0 +1,940 @@
+/**
+ *	AVLTreeBench.cpp
+ *
+ *	Benchmark harness for the AVL tree.
+ *	Every workload is driven by a fixed seed, so two runs of the same build on
+ *	the same machine operate on identical keys in an identical order.
+ *
+ *	Results are written to standard output as a single JSON document holding
+ *	the throughput, the median and 99th percentile latency of every workload,
+ *	and the peak resident set size of the process.
+ *
+ *	Usage: `AVLTreeBench [--n <keys>] [--seed <seed>] [--threads <max threads>]`
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <latch>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include <malloc.h>
+#include <sys/resource.h>
+#include "AVLTree.h"
+#include "BPlusTree.h"
+#include "CompactAVLTree.h"
+#include "ConcurrentAVLTree.h"
+#include "FrozenAVLTree.h"
+#include "MappedAVLTree.h"
+#include "PersistentAVLTree.h"
+#include "ShardedAVLTree.h"
+
+using namespace std;
+
+using Clock = chrono::steady_clock;
+
+/** Result of one workload. */
+struct BenchResult {
+	string name;
+	size_t ops;
+	double seconds;
+	double p50;
+	double p99;
+};
+
+/**
+ *	Reads the clock twice in a row many times, and returns the median gap in
+ *	nanoseconds. Every latency sample includes one such gap, which is taken
+ *	off again, since it is a sizable part of a lookup that takes a few hundred
+ *	nanoseconds.
+ */
+double timerCost() {
+	static const double cost = [] {
+		vector<double> gaps(1001);
+		for (double &gap : gaps) {
+			Clock::time_point start = Clock::now();
+			Clock::time_point stop = Clock::now();
+			gap = chrono::duration<double, nano>(stop - start).count();
+		}
+		nth_element(gaps.begin(), gaps.begin() + gaps.size() / 2, gaps.end());
+		return gaps[gaps.size() / 2];
+	}();
+	return cost;
+}
+
+/**
+ *	Collects the latency of the operations of a workload in nanoseconds.
+ *	The median and tail latencies are taken from the sorted samples.
+ *
+ *	`run()` times a whole loop of short operations for the throughput, and
+ *	only every `SAMPLE_STRIDE`th operation on its own, so that reading the
+ *	clock barely slows the loop down. `measure()` times a single operation,
+ *	for workloads whose operations are long or interleaved with others.
+ */
+class LatencyRecorder {
+	public:
+		static constexpr size_t SAMPLE_STRIDE = 16;
+
+		explicit LatencyRecorder(size_t expected) : ops(0), seconds(0) {this->samples.reserve(expected);}
+
+		/** Calls `op(i)` for every `i` in `[0, count)`. */
+		template <typename Op>
+		void run(size_t count, Op &&op) {
+			Clock::time_point loopStart = Clock::now();
+			for (size_t i = 0; i < count; ++i) {
+				if (i % SAMPLE_STRIDE == 0) {
+					Clock::time_point start = Clock::now();
+					op(i);
+					Clock::time_point stop = Clock::now();
+					this->record(chrono::duration<double, nano>(stop - start).count());
+				} else {
+					op(i);
+				}
+			}
+			Clock::time_point loopStop = Clock::now();
+
+			size_t sampled = (count + SAMPLE_STRIDE - 1) / SAMPLE_STRIDE;
+			double loop = chrono::duration<double, nano>(loopStop - loopStart).count() - sampled * timerCost();
+			this->ops += count;
+			this->seconds += max(loop, 0.0) / 1e9;
+		}
+
+		template <typename Op>
+		void measure(Op &&op) {
+			Clock::time_point start = Clock::now();
+			op();
+			Clock::time_point stop = Clock::now();
+			double sample = this->record(chrono::duration<double, nano>(stop - start).count());
+			this->ops += 1;
+			this->seconds += sample / 1e9;
+		}
+
+		BenchResult finish(const string &name) {
+			sort(this->samples.begin(), this->samples.end());
+			return BenchResult{
+				name, this->ops, this->seconds,
+				this->percentile(0.50), this->percentile(0.99)
+			};
+		}
+
+	private:
+		vector<double> samples;
+		size_t ops;
+		double seconds;
+
+		double record(double elapsed) {
+			double sample = max(elapsed - timerCost(), 0.0);
+			this->samples.push_back(sample);
+			return sample;
+		}
+
+		double percentile(double p) const {
+			if (this->samples.empty()) {return 0;}
+			size_t index = static_cast<size_t>(p * (this->samples.size() - 1));
+			return this->samples[index];
+		}
+};
+
+/**
+ *	Zero padded keys, so the lexicographic order of the keys matches the
+ *	numeric order of their indices.
+ */
+string makeKey(uint64_t index) {
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "key%012" PRIu64, index);
+	return string{buffer};
+}
+
+/** Keys that sort between the existing keys, but are never inserted. */
+string makeMissKey(uint64_t index) {
+	return makeKey(index) + "~";
+}
+
+/**
+ *	Draws indices in `[0, n)` with probability proportional to `1 / (rank + 1)^s`.
+ *	The cumulative distribution is precomputed once, so each draw is a binary search.
+ */
+class ZipfGenerator {
+	public:
+		ZipfGenerator(size_t n, double s) : cdf(n) {
+			double sum = 0;
+			for (size_t i = 0; i < n; ++i) {
+				sum += 1.0 / pow(static_cast<double>(i + 1), s);
+				this->cdf[i] = sum;
+			}
+			for (double &c : this->cdf) {c /= sum;}
+		}
+
+		template <typename Rng>
+		size_t operator()(Rng &rng) {
+			double u = uniform_real_distribution<double>(0.0, 1.0)(rng);
+			size_t index = lower_bound(this->cdf.begin(), this->cdf.end(), u) - this->cdf.begin();
+			return min(index, this->cdf.size() - 1);
+		}
+
+	private:
+		vector<double> cdf;
+};
+
+/** Peak resident set size of this process in kilobytes. */
+long peakRssKilobytes() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+/** Bytes currently allocated from the heap by this process, including blocks mapped on their own. */
+size_t heapBytesInUse() {
+	struct mallinfo2 info = mallinfo2();
+	return info.uordblks + info.hblkhd;
+}
+
+/** Heap bytes per key of the trees holding the shuffled key set. */
+struct Footprint {
+	double avlBytesPerEntry;
+	double compactBytesPerEntry;
+	double btreeBytesPerEntry;
+	double hashIndexBytesPerEntry;
+};
+
+/**
+ *	Aggregate lookup throughput of one number of reader threads, under each
+ *	kind of locking, and on snapshots of the persistent tree, either kept for
+ *	many lookups or taken anew for each one.
+ */
+struct ScalingResult {
+	size_t threads;
+	double sharedOpsPerSec;
+	double sharedWithWriterOpsPerSec;
+	double mutexOpsPerSec;
+	double snapshotOpsPerSec;
+	double snapshotWithWriterOpsPerSec;
+	double snapshotPerLookupOpsPerSec;
+};
+
+/** Aggregate insertion throughput of one number of writer threads, into the sharded and the single-lock tree. */
+struct WriteScalingResult {
+	size_t threads;
+	double shardedOpsPerSec;
+	double concurrentOpsPerSec;
+};
+
+/**
+ *	Runs `op(thread, i)` for `opsPerThread` values of `i` on each of `threads`
+ *	threads at once, and returns the number of operations per second of all threads.
+ */
+template <typename Op>
+double parallelThroughput(size_t threads, size_t opsPerThread, Op &&op) {
+	latch ready(threads + 1);
+	vector<thread> readers;
+	for (size_t t = 0; t < threads; ++t) {
+		readers.emplace_back([&, t] {
+			ready.arrive_and_wait();
+			for (size_t i = 0; i < opsPerThread; ++i) {op(t, i);}
+		});
+	}
+
+	ready.arrive_and_wait();
+	Clock::time_point start = Clock::now();
+	for (thread &reader : readers) {reader.join();}
+	double seconds = chrono::duration<double>(Clock::now() - start).count();
+	return (seconds > 0) ? (threads * opsPerThread / seconds) : 0;
+}
+
+/**
+ *	Prints the counters of a tree built with `AVLTREE_STATS`, with each path
+ *	length histogram cut after its longest path.
+ */
+void printTreeStats(const AVLTreeStats &stats) {
+	static const char *OPERATION_NAMES[AVLTreeStats::OPERATIONS] = {"lookup", "insert", "remove", "split"};
+
+	cout << "  \"tree_stats\": {\"single_rotations\": " << stats.singleRotations
+		<< ", \"double_rotations\": " << stats.doubleRotations
+		<< ", \"comparisons\": " << stats.comparisons
+		<< ", \"long_comparisons\": " << stats.longComparisons
+		<< ", \"nodes_created\": " << stats.nodesCreated
+		<< ", \"nodes_destroyed\": " << stats.nodesDestroyed << ",\n";
+	cout << "    \"path_lengths\": {";
+	for (size_t op = 0; op < AVLTreeStats::OPERATIONS; ++op) {
+		const auto &lengths = stats.pathLengths[op];
+		size_t longest = lengths.size();
+		while (longest > 0 && lengths[longest - 1] == 0) {--longest;}
+
+		cout << ((op > 0) ? ", " : "") << "\"" << OPERATION_NAMES[op] << "\": [";
+		for (size_t d = 0; d < longest; ++d) {cout << ((d > 0) ? ", " : "") << lengths[d];}
+		cout << "]";
+	}
+	cout << "}},\n";
+}
+
+void printJson(
+	const vector<BenchResult> &results, size_t n, uint64_t seed,
+	size_t churnSlabAllocations, const Footprint &footprint, const vector<ScalingResult> &scaling,
+	const vector<WriteScalingResult> &writeScaling, const AVLTreeStats &treeStats, const LookupCacheStats &cacheStats
+) {
+	cout << fixed << setprecision(1);
+	cout << "{\n";
+	cout << "  \"n\": " << n << ",\n";
+	cout << "  \"seed\": " << seed << ",\n";
+	cout << "  \"peak_rss_kb\": " << peakRssKilobytes() << ",\n";
+	cout << "  \"churn_slab_allocations\": " << churnSlabAllocations << ",\n";
+	cout << "  \"avl_bytes_per_entry\": " << footprint.avlBytesPerEntry << ",\n";
+	cout << "  \"compact_bytes_per_entry\": " << footprint.compactBytesPerEntry << ",\n";
+	cout << "  \"btree_bytes_per_entry\": " << footprint.btreeBytesPerEntry << ",\n";
+	cout << "  \"btree_search_kernel\": \"" << BPlusTree::searchKernel() << "\",\n";
+	cout << "  \"hash_index_bytes_per_entry\": " << footprint.hashIndexBytesPerEntry << ",\n";
+	cout << "  \"lookup_cache_hit_rate\": " << cacheStats.hitRate() << ",\n";
+	cout << "  \"lookup_cache_finger_starts\": " << cacheStats.fingerStarts << ",\n";
+	if constexpr (AVLTree::KEEPS_STATS) {printTreeStats(treeStats);}
+	cout << "  \"workloads\": [\n";
+	for (size_t i = 0; i < results.size(); ++i) {
+		const BenchResult &r = results[i];
+		double opsPerSec = (r.seconds > 0) ? (r.ops / r.seconds) : 0;
+		cout << "    {\"name\": \"" << r.name << "\", \"ops\": " << r.ops
+			<< ", \"ops_per_sec\": " << static_cast<uint64_t>(opsPerSec)
+			<< ", \"p50_ns\": " << r.p50
+			<< ", \"p99_ns\": " << r.p99 << "}"
+			<< ((i + 1 < results.size()) ? ",\n" : "\n");
+	}
+	cout << "  ],\n";
+	cout << "  \"read_scaling\": [\n";
+	for (size_t i = 0; i < scaling.size(); ++i) {
+		const ScalingResult &r = scaling[i];
+		cout << "    {\"threads\": " << r.threads
+			<< ", \"shared_ops_per_sec\": " << static_cast<uint64_t>(r.sharedOpsPerSec)
+			<< ", \"shared_with_writer_ops_per_sec\": " << static_cast<uint64_t>(r.sharedWithWriterOpsPerSec)
+			<< ", \"mutex_ops_per_sec\": " << static_cast<uint64_t>(r.mutexOpsPerSec)
+			<< ", \"snapshot_ops_per_sec\": " << static_cast<uint64_t>(r.snapshotOpsPerSec)
+			<< ", \"snapshot_with_writer_ops_per_sec\": " << static_cast<uint64_t>(r.snapshotWithWriterOpsPerSec)
+			<< ", \"snapshot_per_lookup_ops_per_sec\": " << static_cast<uint64_t>(r.snapshotPerLookupOpsPerSec) << "}"
+			<< ((i + 1 < scaling.size()) ? ",\n" : "\n");
+	}
+	cout << "  ],\n";
+	cout << "  \"write_scaling\": [\n";
+	for (size_t i = 0; i < writeScaling.size(); ++i) {
+		const WriteScalingResult &r = writeScaling[i];
+		cout << "    {\"threads\": " << r.threads
+			<< ", \"sharded_ops_per_sec\": " << static_cast<uint64_t>(r.shardedOpsPerSec)
+			<< ", \"concurrent_ops_per_sec\": " << static_cast<uint64_t>(r.concurrentOpsPerSec) << "}"
+			<< ((i + 1 < writeScaling.size()) ? ",\n" : "\n");
+	}
+	cout << "  ]\n";
+	cout << "}\n";
+}
+
+int main(int argc, char *argv[]) {
+	size_t n = 200000;
+	uint64_t seed = 0x5eed;
+	size_t maxThreads = max<size_t>(1, thread::hardware_concurrency());
+
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "--n") == 0) {
+			n = strtoull(argv[i + 1], nullptr, 10);
+		} else if (strcmp(argv[i], "--seed") == 0) {
+			seed = strtoull(argv[i + 1], nullptr, 10);
+		} else if (strcmp(argv[i], "--threads") == 0) {
+			maxThreads = max<size_t>(1, strtoull(argv[i + 1], nullptr, 10));
+		} else {
+			cerr << "Unknown option " << argv[i] << "\n";
+			return 1;
+		}
+	}
+
+	mt19937_64 rng(seed);
+	vector<BenchResult> results;
+
+	vector<string> sequential(n);
+	for (size_t i = 0; i < n; ++i) {sequential[i] = makeKey(i);}
+
+	vector<string> shuffled = sequential;
+	shuffle(shuffled.begin(), shuffled.end(), rng);
+
+	vector<string> misses(n);
+	for (size_t i = 0; i < n; ++i) {misses[i] = makeMissKey(i);}
+	shuffle(misses.begin(), misses.end(), rng);
+
+	/* Insertion workloads. */
+	{
+		AVLTree tree;
+		LatencyRecorder recorder(n);
+		recorder.run(n, [&](size_t i) {tree.insert(sequential[i], i);});
+		results.push_back(recorder.finish("insert_sequential"));
+	}
+
+	AVLTree tree;
+	{
+		LatencyRecorder recorder(n);
+		recorder.run(n, [&](size_t i) {tree.insert(shuffled[i], i);});
+		results.push_back(recorder.finish("insert_random"));
+	}
+
+	{
+		AVLTree zipfTree;
+		ZipfGenerator zipf(n, 0.99);
+		vector<size_t> draws(n);
+		for (size_t &draw : draws) {draw = zipf(rng);}
+
+		LatencyRecorder recorder(n);
+		recorder.run(n, [&](size_t i) {zipfTree.insert(shuffled[draws[i]], i);});
+		results.push_back(recorder.finish("insert_zipf"));
+	}
+
+	/* Bulk loads of the whole key set, where each operation builds an entire tree. */
+	{
+		vector<pair<string, size_t>> sortedPairs(n), shuffledPairs(n);
+		for (size_t i = 0; i < n; ++i) {
+			sortedPairs[i] = {sequential[i], i};
+			shuffledPairs[i] = {shuffled[i], i};
+		}
+
+		volatile size_t sink = 0;
+		LatencyRecorder sortedLoads(5), shuffledLoads(5);
+		for (size_t i = 0; i < 5; ++i) {
+			sortedLoads.measure([&] {
+				AVLTree loaded(sortedPairs.begin(), sortedPairs.end());
+				sink = sink + loaded.size();
+			});
+		}
+		for (size_t i = 0; i < 5; ++i) {
+			shuffledLoads.measure([&] {
+				AVLTree loaded(shuffledPairs.begin(), shuffledPairs.end());
+				sink = sink + loaded.size();
+			});
+		}
+		results.push_back(sortedLoads.finish("bulk_load_sorted"));
+		results.push_back(shuffledLoads.finish("bulk_load_shuffled"));
+	}
+
+	/*	Batches of fresh keys, a sixteenth and a half of the tree's size, inserted
+		into copies of the random tree one at a time and through `insertBatch()`,
+		then removed again through `removeBatch()`. Every sample is one whole batch. */
+	for (size_t divisor : {16, 2}) {
+		size_t batchSize = n / divisor;
+		vector<pair<string, size_t>> batch(batchSize);
+		for (size_t i = 0; i < batchSize; ++i) {batch[i] = {misses[i], i};}
+
+		LatencyRecorder loop(3), batched(3), removed(3);
+		for (size_t round = 0; round < 3; ++round) {
+			AVLTree perKey = tree, merged = tree;
+			loop.measure([&] {
+				for (const auto &[key, value] : batch) {perKey.insert(key, value);}
+			});
+			batched.measure([&] {merged.insertBatch(batch.begin(), batch.end());});
+			removed.measure([&] {merged.removeBatch(misses.begin(), misses.begin() + batchSize);});
+		}
+		string suffix = "_n_over_" + to_string(divisor);
+		results.push_back(loop.finish("insert_loop" + suffix));
+		results.push_back(batched.finish("insert_batch" + suffix));
+		results.push_back(removed.finish("remove_batch" + suffix));
+	}
+
+	/*	Expiry of a tenth of the key space: one `remove()` per key against
+		`removeRange()`, on copies of the random tree. Then a split at the
+		median key and the join that puts the two halves back together. */
+	{
+		vector<string> sortedKeys = shuffled;
+		sort(sortedKeys.begin(), sortedKeys.end());
+		const string &low = sortedKeys[n / 2];
+		const string &high = sortedKeys[n / 2 + n / 10];
+
+		LatencyRecorder perKey(3), ranged(3), splits(3), joins(3);
+		for (size_t round = 0; round < 3; ++round) {
+			AVLTree a = tree, b = tree;
+			perKey.measure([&] {
+				for (size_t i = n / 2; i <= n / 2 + n / 10; ++i) {a.remove(sortedKeys[i]);}
+			});
+			ranged.measure([&] {b.removeRange(low, high);});
+
+			AVLTree upper;
+			splits.measure([&] {upper = b.split(low);});
+			joins.measure([&] {b.join(std::move(upper));});
+		}
+		results.push_back(perKey.finish("expire_range_per_key"));
+		results.push_back(ranged.finish("expire_range"));
+		results.push_back(splits.finish("split"));
+		results.push_back(joins.finish("join"));
+	}
+
+	/*	The whole-tree operations, each on one thread and forked across a pool of
+		`maxThreads` workers: a bulk load of the sorted key set, a deep copy, a
+		clear, and the union of the random tree with the miss keys. */
+	{
+		ThreadPool pool(maxThreads);
+		vector<pair<string, size_t>> sortedPairs(n), missPairs(n);
+		for (size_t i = 0; i < n; ++i) {
+			sortedPairs[i] = {sequential[i], i};
+			missPairs[i] = {misses[i], i};
+		}
+		sort(missPairs.begin(), missPairs.end());
+		AVLTree missTree(missPairs.begin(), missPairs.end());
+
+		volatile size_t sink = 0;
+		LatencyRecorder loads(5), copies(5), clears(5), clearsParallel(5), unions(3), unionsParallel(3);
+		for (size_t i = 0; i < 5; ++i) {
+			AVLTree loaded;
+			loads.measure([&] {loaded.bulkLoad(sortedPairs.begin(), sortedPairs.end(), pool);});
+			copies.measure([&] {
+				AVLTree copy(tree, pool);
+				sink = sink + copy.size();
+			});
+
+			AVLTree a = tree, b = tree;
+			clears.measure([&] {a.clear();});
+			clearsParallel.measure([&] {b.clear(pool);});
+		}
+		for (size_t i = 0; i < 3; ++i) {
+			AVLTree a = tree, b = tree, other = missTree, otherParallel = missTree;
+			unions.measure([&] {sink = sink + a.unionWith(std::move(other));});
+			unionsParallel.measure([&] {sink = sink + b.unionWith(std::move(otherParallel), pool);});
+		}
+		results.push_back(loads.finish("bulk_load_sorted_parallel"));
+		results.push_back(copies.finish("copy_parallel"));
+		results.push_back(clears.finish("clear"));
+		results.push_back(clearsParallel.finish("clear_parallel"));
+		results.push_back(unions.finish("union"));
+		results.push_back(unionsParallel.finish("union_parallel"));
+	}
+
+	/*	Cold start from a binary snapshot of the random tree: saving it, which
+		includes flushing the file to the disk, loading it back into a tree,
+		and opening it as a mapped view, which is then queried in place. */
+	{
+		string path = (filesystem::temp_directory_path() / "AVLTreeBench.snapshot").string();
+		volatile size_t sink = 0;
+		LatencyRecorder saves(5), loads(5), opens(5);
+		MappedAVLTree mapped;
+		for (size_t i = 0; i < 5; ++i) {
+			saves.measure([&] {sink = sink + tree.save(path);});
+			loads.measure([&] {
+				AVLTree loaded;
+				sink = sink + loaded.load(path);
+			});
+			opens.measure([&] {sink = sink + mapped.open(path);});
+		}
+
+		LatencyRecorder hitGet(n);
+		hitGet.run(n, [&](size_t i) {sink = sink + mapped.get(shuffled[n - 1 - i]).value_or(0);});
+		mapped.close();
+		filesystem::remove(path);
+
+		results.push_back(saves.finish("snapshot_save"));
+		results.push_back(loads.finish("snapshot_load"));
+		results.push_back(opens.finish("snapshot_open_mapped"));
+		results.push_back(hitGet.finish("mapped_get_hit"));
+	}
+
+	/* Point lookups on the randomly built tree. */
+	{
+		volatile size_t sink = 0;
+		LatencyRecorder hitGet(n), missGet(n), hitContains(n), missContains(n);
+		hitGet.run(n, [&](size_t i) {sink = sink + tree.get(shuffled[n - 1 - i]).value_or(0);});
+		missGet.run(n, [&](size_t i) {sink = sink + tree.get(misses[i]).value_or(0);});
+		hitContains.run(n, [&](size_t i) {sink = sink + tree.contains(shuffled[i]);});
+		missContains.run(n, [&](size_t i) {sink = sink + tree.contains(misses[i]);});
+		results.push_back(hitGet.finish("get_hit"));
+		results.push_back(missGet.finish("get_miss"));
+		results.push_back(hitContains.finish("contains_hit"));
+		results.push_back(missContains.finish("contains_miss"));
+	}
+
+	/* Skewed and in-order lookups on the random tree, without and with the lookup cache. */
+	LookupCacheStats cacheStats;
+	{
+		/* A generator of its own, so the workloads after this one keep their keys. */
+		mt19937_64 zipfRng(seed);
+		ZipfGenerator zipf(n, 0.99);
+		vector<size_t> draws(n);
+		for (size_t &draw : draws) {draw = zipf(zipfRng);}
+
+		volatile size_t sink = 0;
+		LatencyRecorder zipfGet(n), sequentialGet(n), cachedZipfGet(n), cachedSequentialGet(n);
+		zipfGet.run(n, [&](size_t i) {sink = sink + tree.get(shuffled[draws[i]]).value_or(0);});
+		sequentialGet.run(n, [&](size_t i) {sink = sink + tree.get(sequential[i]).value_or(0);});
+
+		tree.setLookupCache(true);
+		AVLTree::resetLookupCacheStats();
+		cachedZipfGet.run(n, [&](size_t i) {sink = sink + tree.get(shuffled[draws[i]]).value_or(0);});
+		cacheStats = AVLTree::lookupCacheStats();
+		cachedSequentialGet.run(n, [&](size_t i) {sink = sink + tree.get(sequential[i]).value_or(0);});
+		cacheStats.fingerStarts = AVLTree::lookupCacheStats().fingerStarts;
+		tree.setLookupCache(false);
+
+		results.push_back(zipfGet.finish("get_zipf"));
+		results.push_back(sequentialGet.finish("get_sequential"));
+		results.push_back(cachedZipfGet.finish("cached_get_zipf"));
+		results.push_back(cachedSequentialGet.finish("cached_get_sequential"));
+	}
+
+	/* The same lookups on a frozen copy of the random tree, and the cost of freezing it. */
+	{
+		volatile size_t sink = 0;
+		FrozenAVLTree frozen;
+		LatencyRecorder freezes(5);
+		for (size_t i = 0; i < 5; ++i) {
+			freezes.measure([&] {frozen = tree.freeze();});
+		}
+
+		LatencyRecorder hitGet(n), missGet(n), lowerBounds(n);
+		hitGet.run(n, [&](size_t i) {sink = sink + frozen.get(shuffled[n - 1 - i]).value_or(0);});
+		missGet.run(n, [&](size_t i) {sink = sink + frozen.get(misses[i]).value_or(0);});
+		lowerBounds.run(n, [&](size_t i) {sink = sink + (frozen.lower_bound(misses[i]) - frozen.begin());});
+		results.push_back(freezes.finish("freeze"));
+		results.push_back(hitGet.finish("frozen_get_hit"));
+		results.push_back(missGet.finish("frozen_get_miss"));
+		results.push_back(lowerBounds.finish("frozen_lower_bound"));
+	}
+
+	/* What the random insertions and the point lookups cost the tree, if it keeps stats. */
+	AVLTreeStats treeStats = tree.stats();
+
+	/*	Batches of 256 hits: a loop of `get()`, and `getBatch()` with interleaved
+		descents, as given and sorted first. Every sample is one whole batch. */
+	{
+		const size_t batchSize = 256;
+		volatile size_t sink = 0;
+		vector<optional<size_t>> values(batchSize);
+		size_t batches = n / batchSize;
+		LatencyRecorder loop(batches), batched(batches), sortedBatched(batches);
+		for (size_t b = 0; b < batches; ++b) {
+			span<const string> batch(shuffled.data() + b * batchSize, batchSize);
+			loop.measure([&] {
+				for (size_t i = 0; i < batchSize; ++i) {values[i] = tree.get(batch[i]);}
+			});
+			batched.measure([&] {tree.getBatch(batch, values);});
+			sortedBatched.measure([&] {tree.getBatch(batch, values, true);});
+			sink = sink + values[0].value_or(0);
+		}
+		results.push_back(loop.finish("get_loop_256"));
+		results.push_back(batched.finish("get_batch_256"));
+		results.push_back(sortedBatched.finish("get_batch_256_sorted"));
+	}
+
+	/* The same lookups on the compact layout, and the heap held by each layout. */
+	Footprint footprint{};
+	{
+		size_t heapBefore = heapBytesInUse();
+		CompactAVLTree compact;
+		LatencyRecorder inserts(n);
+		inserts.run(n, [&](size_t i) {compact.insert(shuffled[i], i);});
+		footprint.compactBytesPerEntry = static_cast<double>(heapBytesInUse() - heapBefore) / n;
+
+		heapBefore = heapBytesInUse();
+		{
+			AVLTree copy(tree);
+			footprint.avlBytesPerEntry = static_cast<double>(heapBytesInUse() - heapBefore) / n;
+		}
+
+		volatile size_t sink = 0;
+		LatencyRecorder hitGet(n), missGet(n);
+		hitGet.run(n, [&](size_t i) {sink = sink + compact.get(shuffled[n - 1 - i]).value_or(0);});
+		missGet.run(n, [&](size_t i) {sink = sink + compact.get(misses[i]).value_or(0);});
+		results.push_back(inserts.finish("compact_insert_random"));
+		results.push_back(hitGet.finish("compact_get_hit"));
+		results.push_back(missGet.finish("compact_get_miss"));
+	}
+
+	/* The same workloads on the B+ tree, head to head with the AVL tree, whose removals are timed on a copy. */
+	{
+		size_t heapBefore = heapBytesInUse();
+		BPlusTree btree;
+		LatencyRecorder inserts(n);
+		inserts.run(n, [&](size_t i) {btree.insert(shuffled[i], i);});
+		footprint.btreeBytesPerEntry = static_cast<double>(heapBytesInUse() - heapBefore) / n;
+
+		volatile size_t sink = 0;
+		LatencyRecorder hitGet(n), missGet(n);
+		hitGet.run(n, [&](size_t i) {sink = sink + btree.get(shuffled[n - 1 - i]).value_or(0);});
+		missGet.run(n, [&](size_t i) {sink = sink + btree.get(misses[i]).value_or(0);});
+
+		/* A generator of its own, so the workloads after this one keep their keys. */
+		mt19937_64 scanRng(seed);
+		size_t width = max<size_t>(1, n / 10000);
+		size_t queries = min<size_t>(n, 10000);
+		uniform_int_distribution<size_t> start(0, n - width);
+		LatencyRecorder ranges(queries);
+		for (size_t q = 0; q < queries; ++q) {
+			size_t low = start(scanRng);
+			ranges.measure([&] {
+				btree.visitRange(sequential[low], sequential[low + width - 1],
+					[&](const string &, size_t value) {sink = sink + value;});
+			});
+		}
+
+		AVLTree copy(tree);
+		LatencyRecorder avlRemoves(n), btreeRemoves(n);
+		avlRemoves.run(n, [&](size_t i) {sink = sink + copy.remove(shuffled[i]);});
+		btreeRemoves.run(n, [&](size_t i) {sink = sink + btree.remove(shuffled[i]);});
+
+		results.push_back(inserts.finish("btree_insert_random"));
+		results.push_back(hitGet.finish("btree_get_hit"));
+		results.push_back(missGet.finish("btree_get_miss"));
+		results.push_back(ranges.finish("btree_visit_range_narrow"));
+		results.push_back(avlRemoves.finish("remove_random"));
+		results.push_back(btreeRemoves.finish("btree_remove_random"));
+	}
+
+	/* The same point lookups on a tree with a hash index, which insertions keep up to date. */
+	{
+		AVLTree indexed;
+		indexed.setHashIndex(true);
+		LatencyRecorder inserts(n);
+		inserts.run(n, [&](size_t i) {indexed.insert(shuffled[i], i);});
+		footprint.hashIndexBytesPerEntry = static_cast<double>(indexed.hashIndexMemory()) / n;
+
+		volatile size_t sink = 0;
+		LatencyRecorder hitGet(n), missGet(n);
+		hitGet.run(n, [&](size_t i) {sink = sink + indexed.get(shuffled[n - 1 - i]).value_or(0);});
+		missGet.run(n, [&](size_t i) {sink = sink + indexed.get(misses[i]).value_or(0);});
+		results.push_back(inserts.finish("indexed_insert_random"));
+		results.push_back(hitGet.finish("indexed_get_hit"));
+		results.push_back(missGet.finish("indexed_get_miss"));
+	}
+
+	/* Path-copying tree: updates publish new versions, lookups run on a snapshot, copies share the root. */
+	{
+		PersistentAVLTree persistent;
+		LatencyRecorder inserts(n);
+		inserts.run(n, [&](size_t i) {persistent.insert(shuffled[i], i);});
+
+		volatile size_t sink = 0;
+		PersistentAVLTree::Snapshot snapshot = persistent.snapshot();
+		LatencyRecorder hitGet(n);
+		hitGet.run(n, [&](size_t i) {sink = sink + snapshot.get(shuffled[n - 1 - i]).value_or(0);});
+
+		LatencyRecorder deepCopies(5), sharedCopies(5);
+		for (size_t i = 0; i < 5; ++i) {
+			deepCopies.measure([&] {
+				AVLTree copy(tree);
+				sink = sink + copy.size();
+			});
+			sharedCopies.measure([&] {
+				PersistentAVLTree copy(persistent);
+				sink = sink + copy.snapshot().size();
+			});
+		}
+
+		results.push_back(inserts.finish("persistent_insert_random"));
+		results.push_back(hitGet.finish("persistent_snapshot_get_hit"));
+		results.push_back(deepCopies.finish("copy_deep"));
+		results.push_back(sharedCopies.finish("copy_persistent"));
+	}
+
+	/* Range queries of several selectivities. */
+	for (double selectivity : {0.0001, 0.01, 0.1}) {
+		size_t width = max<size_t>(1, static_cast<size_t>(selectivity * n));
+		size_t queries = max<size_t>(10, static_cast<size_t>(0.1 / selectivity));
+		uniform_int_distribution<size_t> start(0, n - width);
+
+		volatile size_t sink = 0;
+		LatencyRecorder recorder(queries);
+		for (size_t q = 0; q < queries; ++q) {
+			size_t low = start(rng);
+			recorder.measure([&] {
+				sink = sink + tree.findRange(sequential[low], sequential[low + width - 1]).size();
+			});
+		}
+
+		char name[64];
+		snprintf(name, sizeof(name), "find_range_%gpct", selectivity * 100);
+		results.push_back(recorder.finish(name));
+	}
+
+	/* Narrow half-open scans streamed into a visitor, without materializing the values. */
+	{
+		size_t width = max<size_t>(1, n / 10000);
+		size_t queries = min<size_t>(n, 10000);
+		uniform_int_distribution<size_t> start(0, n - width);
+
+		volatile size_t sink = 0;
+		LatencyRecorder recorder(queries);
+		for (size_t q = 0; q < queries; ++q) {
+			size_t low = start(rng);
+			recorder.measure([&] {
+				tree.visitRange(sequential[low], sequential[low + width - 1],
+					[&](const string &, size_t value) {sink = sink + value;},
+					AVLTree::Bound::INCLUSIVE, AVLTree::Bound::EXCLUSIVE);
+			});
+		}
+		results.push_back(recorder.finish("visit_range_narrow"));
+	}
+
+	/* Order statistics: counting a wide range, selecting by position and paging. */
+	{
+		size_t width = max<size_t>(1, n / 10);
+		size_t queries = min<size_t>(n, 10000);
+		uniform_int_distribution<size_t> start(0, n - width);
+		uniform_int_distribution<size_t> position(0, n - 1);
+
+		volatile size_t sink = 0;
+		LatencyRecorder counts(queries), selects(queries), pages(queries);
+		for (size_t q = 0; q < queries; ++q) {
+			size_t low = start(rng);
+			counts.measure([&] {sink = sink + tree.countRange(sequential[low], sequential[low + width - 1]);});
+		}
+		for (size_t q = 0; q < queries; ++q) {
+			size_t k = position(rng);
+			selects.measure([&] {sink = sink + tree.select(k)->size();});
+		}
+		for (size_t q = 0; q < queries; ++q) {
+			size_t offset = position(rng);
+			pages.measure([&] {sink = sink + tree.keysPage(offset, 50).size();});
+		}
+		results.push_back(counts.finish("count_range_10pct"));
+		results.push_back(selects.finish("select"));
+		results.push_back(pages.finish("keys_page_50"));
+	}
+
+	/* Full key dumps. */
+	{
+		volatile size_t sink = 0;
+		LatencyRecorder recorder(5);
+		for (size_t i = 0; i < 5; ++i) {
+			recorder.measure([&] {sink = sink + tree.keys().size();});
+		}
+		results.push_back(recorder.finish("keys"));
+	}
+
+	/* Full in-order scans through the iterators, which copy nothing. */
+	{
+		volatile size_t sink = 0;
+		LatencyRecorder recorder(5);
+		for (size_t i = 0; i < 5; ++i) {
+			recorder.measure([&] {
+				for (const AVLTree::Entry &entry : tree) {sink = sink + entry.value;}
+			});
+		}
+		results.push_back(recorder.finish("iterate"));
+	}
+
+	/*	Read scaling: concurrent lookups through the reader-writer tree, the same
+		while a writer queues batched updates, and through a single global mutex.
+		Then lookups on snapshots of the persistent tree, which each reader
+		renews every `SNAPSHOT_REUSE` lookups, the same while a writer publishes
+		versions, and with a snapshot taken for every lookup. */
+	vector<ScalingResult> scaling;
+	vector<size_t> threadCounts;
+	for (size_t threads = 1; threads < maxThreads; threads *= 2) {threadCounts.push_back(threads);}
+	threadCounts.push_back(maxThreads);
+	{
+		ConcurrentAVLTree shared;
+		shared.write([&](AVLTree &inner) {inner = tree;});
+		mutex globalMutex;
+		PersistentAVLTree persistent;
+		for (size_t i = 0; i < n; ++i) {persistent.insert(shuffled[i], i);}
+		constexpr size_t SNAPSHOT_REUSE = 1024;
+
+		size_t opsPerThread = min<size_t>(n, 200000);
+
+		for (size_t threads : threadCounts) {
+			ScalingResult r{threads, 0, 0, 0, 0, 0, 0};
+			atomic<size_t> sink = 0;
+			auto key = [&](size_t t, size_t i) -> const string & {return shuffled[(t * 7919 + i) % n];};
+
+			r.sharedOpsPerSec = parallelThroughput(threads, opsPerThread, [&](size_t t, size_t i) {
+				sink.fetch_add(shared.get(key(t, i)).value_or(0), memory_order_relaxed);
+			});
+			r.mutexOpsPerSec = parallelThroughput(threads, opsPerThread, [&](size_t t, size_t i) {
+				lock_guard lock(globalMutex);
+				sink.fetch_add(tree.get(key(t, i)).value_or(0), memory_order_relaxed);
+			});
+
+			atomic<bool> stop = false;
+			thread writer([&] {
+				for (size_t i = 0; !stop.load(memory_order_relaxed); ++i) {
+					const string &missKey = misses[i % n];
+					if ((i / n) % 2 == 0) {
+						shared.queueInsert(missKey, i);
+					} else {
+						shared.queueRemove(missKey);
+					}
+				}
+			});
+			r.sharedWithWriterOpsPerSec = parallelThroughput(threads, opsPerThread, [&](size_t t, size_t i) {
+				sink.fetch_add(shared.get(key(t, i)).value_or(0), memory_order_relaxed);
+			});
+			stop = true;
+			writer.join();
+			shared.flush();
+
+			vector<PersistentAVLTree::Snapshot> snapshots(threads);
+			auto snapshotGet = [&](size_t t, size_t i) {
+				if (i % SNAPSHOT_REUSE == 0) {snapshots[t] = persistent.snapshot();}
+				sink.fetch_add(snapshots[t].get(key(t, i)).value_or(0), memory_order_relaxed);
+			};
+			r.snapshotOpsPerSec = parallelThroughput(threads, opsPerThread, snapshotGet);
+			r.snapshotPerLookupOpsPerSec = parallelThroughput(threads, opsPerThread, [&](size_t t, size_t i) {
+				sink.fetch_add(persistent.snapshot().get(key(t, i)).value_or(0), memory_order_relaxed);
+			});
+
+			stop = false;
+			thread publisher([&] {
+				for (size_t i = 0; !stop.load(memory_order_relaxed); ++i) {
+					const string &missKey = misses[i % n];
+					if ((i / n) % 2 == 0) {
+						persistent.insert(missKey, i);
+					} else {
+						persistent.remove(missKey);
+					}
+				}
+			});
+			r.snapshotWithWriterOpsPerSec = parallelThroughput(threads, opsPerThread, snapshotGet);
+			stop = true;
+			publisher.join();
+			snapshots.clear();
+
+			scaling.push_back(r);
+		}
+	}
+
+	/*	Write scaling: every thread inserts its own share of fresh keys, into a
+		hash-sharded tree and into the reader-writer tree with its single lock. */
+	vector<WriteScalingResult> writeScaling;
+	for (size_t threads : threadCounts) {
+		WriteScalingResult r{threads, 0, 0};
+		size_t opsPerThread = max<size_t>(1, n / threads);
+		auto key = [&](size_t t, size_t i) -> const string & {return misses[(t * opsPerThread + i) % n];};
+
+		ShardedAVLTree sharded(4 * maxThreads);
+		r.shardedOpsPerSec = parallelThroughput(threads, opsPerThread, [&](size_t t, size_t i) {
+			sharded.insert(key(t, i), i);
+		});
+		ConcurrentAVLTree concurrent;
+		r.concurrentOpsPerSec = parallelThroughput(threads, opsPerThread, [&](size_t t, size_t i) {
+			concurrent.insert(key(t, i), i);
+		});
+
+		writeScaling.push_back(r);
+	}
+
+	/* Steady-state churn: every removal is followed by a reinsertion of the same key. */
+	size_t slabsBeforeChurn = tree.allocationStats().slabAllocations;
+	{
+		LatencyRecorder recorder(2 * n);
+		uniform_int_distribution<size_t> pick(0, n - 1);
+		for (size_t i = 0; i < n; ++i) {
+			const string &key = shuffled[pick(rng)];
+			recorder.measure([&] {tree.remove(key);});
+			recorder.measure([&] {tree.insert(key, i);});
+		}
+		results.push_back(recorder.finish("remove_churn"));
+	}
+
+	printJson(
+		results, n, seed, tree.allocationStats().slabAllocations - slabsBeforeChurn, footprint, scaling, writeScaling,
+		treeStats, cacheStats
+	);
+	return 0;
+}
@@ -4,16 +4,982 @@
  *	instead for you to get an idea of how to test the tree.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <random>
 #include <ranges>
+#include <span>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 #include "AVLTree.h"
+#include "BPlusTree.h"
+#include "CompactAVLTree.h"
+#include "ConcurrentAVLTree.h"
+#include "FrozenAVLTree.h"
+#include "MappedAVLTree.h"
+#include "PersistentAVLTree.h"
+#include "ShardedAVLTree.h"
+#include "ThreadPool.h"
 
 using namespace std;
 
 #define RUN_TEST 1
 #define COPY_TEST 0
 #define MEMLEAK_TEST 0
+#define ITERATOR_TEST 1
+#define EMPLACE_TEST 1
+#define BULKLOAD_TEST 1
+#define COMPACT_TEST 1
+#define CONCURRENT_TEST 1
+#define PERSISTENT_TEST 1
+#define SHARDED_TEST 1
+#define BATCH_LOOKUP_TEST 1
+#define BATCH_TEST 1
+#define SET_ALGEBRA_TEST 1
+#define PARALLEL_TEST 1
+#define SNAPSHOT_TEST 1
+#define FROZEN_TEST 1
+#define BPLUSTREE_TEST 1
+#define HASH_INDEX_TEST 1
+#define LOOKUP_CACHE_TEST 1
+
+/*
+ *	The checks below compare the trees with a `std::map` holding the same
+ *	pairs, and each of them prints whether it passed.
+ */
+using Model = map<string, size_t>;
+
+static string keyOf(size_t i) {
+	return "key" + to_string(i);
+}
+
+/**
+ *	An AVL tree of `n` nodes has between `log2(n)` and about `1.44 * log2(n + 2)`
+ *	levels, which a stale height or a lost balance would break. `height` counts
+ *	edges, so an empty tree has a height of `-1` cast to `size_t`.
+ */
+static bool balanced(size_t height, size_t n) {
+	if (n == 0) {
+		return height == static_cast<size_t>(-1);
+	}
+
+	double levels = height + 1;
+	return levels >= floor(log2(n)) + 1 && levels < 1.4405 * log2(n + 2.0) - 0.3277;
+}
+
+/**
+ *	Compares the pairs of `tree` with the `model` in order. The rank of each
+ *	key and the key at each rank are found through the subtree counts, so a
+ *	stale count shows up as a wrong rank.
+ */
+static bool matches(const AVLTree &tree, const Model &model) {
+	if (tree.size() != model.size()) {return false;}
+	size_t rank = 0;
+	auto expected = model.begin();
+	for (const auto &entry : tree) {
+		if (entry.key != expected->first || entry.value != expected->second) {return false;}
+		if (tree.rank(entry.key) != rank || tree.select(rank) != entry.key) {return false;}
+		++expected;
+		++rank;
+	}
+	return balanced(tree.getHeight(), model.size());
+}
+
+/**
+ *	Inserts `count` random pairs with keys below `range` into both the tree and
+ *	the model. Inserting a key that is already there replaces its value.
+ */
+static bool fill(AVLTree &tree, Model &model, mt19937 &rng, size_t count, size_t range) {
+	for (size_t i = 0; i < count; ++i) {
+		string key = keyOf(rng() % range);
+		size_t value = rng() % 100;
+		if (tree.insert(key, value) != model.insert_or_assign(key, value).second) {return false;}
+	}
+	return true;
+}
+
+/** Values of the model's keys in `[low, high]`, each only the first time, like `findRange()`. */
+static vector<size_t> rangeOf(const Model &model, const string &low, const string &high) {
+	vector<size_t> values;
+	unordered_set<size_t> seen;
+	for (auto it = model.lower_bound(low); it != model.upper_bound(high); ++it) {
+		if (seen.insert(it->second).second) {values.push_back(it->second);}
+	}
+	return values;
+}
+
+/** The keys of the model, in order. */
+static vector<string> keysOf(const Model &model) {
+	vector<string> keys;
+	for (const auto &[key, value] : model) {keys.push_back(key);}
+	return keys;
+}
+
+/** Set once any check fails, which makes the driver exit with `1`. */
+static bool failed = false;
+
+static void report(const char *name, bool passed) {
+	cout << name << ": " << (passed ? "ok" : "FAILED") << endl;
+	failed = failed || !passed;
+}
+
+#if defined(ITERATOR_TEST) && (ITERATOR_TEST != 0)
+/** Walks in both directions, and `find()`, `lower_bound()` and `upper_bound()` with steps from their results. */
+static bool checkIterators() {
+	mt19937 rng(6);
+	AVLTree tree;
+	Model model;
+	if (!fill(tree, model, rng, 2000, 5000)) {return false;}
+
+	auto expected = model.begin();
+	for (auto it = tree.begin(); it != tree.end(); ++it, ++expected) {
+		if (expected == model.end() || it->key != expected->first || it->value != expected->second) {return false;}
+	}
+	auto reversed = model.rbegin();
+	for (auto it = tree.end(); it != tree.begin(); ++reversed) {
+		--it;
+		if (reversed == model.rend() || it->key != reversed->first) {return false;}
+	}
+	if (expected != model.end() || reversed != model.rend()) {return false;}
+
+	auto same = [&](AVLTree::iterator it, Model::iterator at) {
+		return (it == tree.end()) ? (at == model.end()) : (at != model.end() && it->key == at->first);
+	};
+	for (size_t i = 0; i < 2000; ++i) {
+		string key = keyOf(rng() % 6000);
+		AVLTree::iterator lower = tree.lower_bound(key);
+		AVLTree::iterator found = tree.find(key);
+		if (!same(lower, model.lower_bound(key)) || !same(tree.upper_bound(key), model.upper_bound(key))) {return false;}
+		if (!same(found, model.find(key))) {return false;}
+		if (lower != tree.begin() && !same(std::prev(lower), std::prev(model.lower_bound(key)))) {return false;}
+		if (lower != tree.end() && !same(std::next(lower), std::next(model.lower_bound(key)))) {return false;}
+		if (found != tree.end()) {
+			found->value = i;
+			model[key] = i;
+		}
+	}
+	return matches(tree, model);
+}
+#endif // ITERATOR_TEST
+
+#if defined(EMPLACE_TEST) && (EMPLACE_TEST != 0)
+/**
+ *	`emplace()`, `try_emplace()` and `insert_or_assign()`, with and without the
+ *	hash index. The iterator each of them returns must point at the key, and
+ *	stepping from it must reach the key's neighbours, so the path it holds
+ *	has to survive the rotation of the insertion.
+ */
+static bool checkEmplace() {
+	mt19937 rng(9);
+	for (bool indexed : {false, true}) {
+		AVLTree tree;
+		tree.setHashIndex(indexed);
+		Model model;
+		for (size_t i = 0; i < 20000; ++i) {
+			string key = keyOf(rng() % 5000);
+			size_t value = rng() % 100;
+			pair<AVLTree::iterator, bool> result;
+			pair<Model::iterator, bool> expected;
+			switch (rng() % 3) {
+				case 0:
+					result = tree.emplace(key, value);
+					expected = model.emplace(key, value);
+					break;
+				case 1:
+					result = tree.try_emplace(key, value);
+					expected = model.try_emplace(key, value);
+					break;
+				default:
+					result = tree.insert_or_assign(key, value);
+					expected = model.insert_or_assign(key, value);
+					break;
+			}
+
+			auto [it, inserted] = result;
+			auto at = expected.first;
+			if (inserted != expected.second || it == tree.end() || it->key != key || it->value != at->second) {return false;}
+			if ((std::next(it) == tree.end()) != (std::next(at) == model.end())) {return false;}
+			if (std::next(it) != tree.end() && std::next(it)->key != std::next(at)->first) {return false;}
+			if ((it == tree.begin()) != (at == model.begin())) {return false;}
+			if (it != tree.begin() && std::prev(it)->key != std::prev(at)->first) {return false;}
+		}
+		if (!matches(tree, model)) {return false;}
+	}
+	return true;
+}
+#endif // EMPLACE_TEST
+
+#if defined(BULKLOAD_TEST) && (BULKLOAD_TEST != 0)
+/**
+ *	What each duplicate policy keeps of the pairs given to `bulkLoad()` and to
+ *	the range constructor, for sorted and unsorted input. A rejected load must
+ *	leave the tree as it was.
+ */
+static bool checkBulkLoad() {
+	using Policy = AVLTree::DuplicatePolicy;
+	mt19937 rng(10);
+	AVLTree tree;
+	Model model;
+	for (size_t round = 0; round < 300; ++round) {
+		vector<pair<string, size_t>> pairs;
+		for (size_t i = 0, n = rng() % 500; i < n; ++i) {pairs.emplace_back(keyOf(rng() % 1000), rng() % 100);}
+		if (round % 2) {stable_sort(pairs.begin(), pairs.end(), [](const auto &a, const auto &b) {return a.first < b.first;});}
+
+		Model first, last;
+		for (const auto &[key, value] : pairs) {
+			first.emplace(key, value);
+			last.insert_or_assign(key, value);
+		}
+
+		Policy policy = static_cast<Policy>(rng() % 3);
+		bool unique = first.size() == pairs.size();
+		bool loaded = tree.bulkLoad(pairs.begin(), pairs.end(), policy);
+		if (policy == Policy::REJECT && !unique) {
+			if (loaded || !matches(tree, model)) {return false;}
+			continue;
+		}
+		model = (policy == Policy::KEEP_LAST) ? last : first;
+		if (!loaded || !matches(tree, model)) {return false;}
+
+		AVLTree built(pairs.begin(), pairs.end());
+		if (!matches(built, first)) {return false;}
+	}
+	return true;
+}
+#endif // BULKLOAD_TEST
+
+#if defined(COMPACT_TEST) && (COMPACT_TEST != 0)
+/**
+ *	Inserts and removals on a compact tree. Half of the keys share a prefix
+ *	longer than the inline bytes of a node, so they are told apart by their
+ *	suffixes in the key arena, and some keys are no longer than the prefix.
+ */
+static bool checkCompact() {
+	mt19937 rng(11);
+	CompactAVLTree tree;
+	Model model;
+	auto compactKey = [&]() {
+		size_t i = rng() % 3000;
+		return (i % 2) ? "a/shared/prefix/" + to_string(i) : to_string(i);
+	};
+	for (size_t i = 0; i < 30000; ++i) {
+		string key = compactKey();
+		if (rng() % 3) {
+			if (tree.insert(key, i) != model.insert_or_assign(key, i).second) {return false;}
+		} else if (tree.remove(key) != (model.erase(key) == 1)) {
+			return false;
+		}
+		if (i % 1000 != 0) {continue;}
+
+		if (tree.size() != model.size() || tree.keys() != keysOf(model)) {return false;}
+		if (!balanced(tree.getHeight(), model.size())) {return false;}
+		for (size_t j = 0; j < 200; ++j) {
+			string probe = compactKey();
+			auto found = model.find(probe);
+			if (tree.contains(probe) != (found != model.end())) {return false;}
+			if (tree.get(probe) != ((found != model.end()) ? optional<size_t>(found->second) : nullopt)) {return false;}
+
+			string low = compactKey(), high = compactKey();
+			if (high < low) {swap(low, high);}
+			if (tree.findRange(low, high) != rangeOf(model, low, high)) {return false;}
+		}
+	}
+	return true;
+}
+#endif // COMPACT_TEST
+
+#if defined(CONCURRENT_TEST) && (CONCURRENT_TEST != 0)
+/**
+ *	Direct and queued writes to a concurrent tree. Queued writes only reach
+ *	the model once `pending()` shows that the queue was flushed, either by
+ *	`flush()` or by the write that filled it.
+ *
+ *	Then several threads write keys of their own at once while another thread
+ *	reads. Half of each thread's keys are only written directly and the other
+ *	half only through the queue, since a queued write lands after the direct
+ *	writes that follow it. The tree must end up with the writes of every
+ *	thread, each applied in the order it was made.
+ */
+static bool checkConcurrent() {
+	mt19937 rng(13);
+	ConcurrentAVLTree tree(64);
+	Model model;
+	vector<pair<string, optional<size_t>>> queued;
+	for (size_t i = 0; i < 20000; ++i) {
+		string key = keyOf(rng() % 2000);
+		bool insert = rng() % 3;
+		switch (rng() % 3) {
+			case 0:
+				if (insert) {
+					if (tree.insert(key, i) != model.insert_or_assign(key, i).second) {return false;}
+				} else if (tree.remove(key) != (model.erase(key) == 1)) {
+					return false;
+				}
+				break;
+			case 1:
+				insert ? tree.queueInsert(key, i) : tree.queueRemove(key);
+				queued.emplace_back(key, insert ? optional<size_t>(i) : nullopt);
+				break;
+			default:
+				if (i % 50 == 0 && tree.flush() != queued.size()) {return false;}
+				break;
+		}
+
+		if (tree.pending() == 0) {
+			for (const auto &[queuedKey, value] : queued) {
+				value ? void(model.insert_or_assign(queuedKey, *value)) : void(model.erase(queuedKey));
+			}
+			queued.clear();
+		}
+		if (tree.pending() != queued.size()) {return false;}
+		if (i % 1000 == 0 && !matches(*tree.read(), model)) {return false;}
+	}
+
+	const size_t threads = 4;
+	ConcurrentAVLTree shared;
+	vector<Model> models(threads);
+	vector<thread> writers;
+	atomic<bool> done = false;
+	atomic<bool> misread = false;
+	thread reader([&]() {
+		mt19937 readRng(130);
+		while (!done) {
+			optional<size_t> value = shared.get(keyOf(readRng() % (1000 * threads)));
+			if (value && *value >= 20000) {misread = true;}
+		}
+	});
+	for (size_t t = 0; t < threads; ++t) {
+		writers.emplace_back([&, t]() {
+			mt19937 writeRng(131 + t);
+			for (size_t i = 0; i < 20000; ++i) {
+				size_t k = writeRng() % 1000;
+				string key = keyOf(k * threads + t);
+				bool insert = writeRng() % 3;
+				if (k % 2) {
+					insert ? shared.queueInsert(key, i) : shared.queueRemove(key);
+				} else if (insert) {
+					shared.insert(key, i);
+				} else {
+					shared.remove(key);
+				}
+				insert ? void(models[t].insert_or_assign(key, i)) : void(models[t].erase(key));
+			}
+		});
+	}
+	for (thread &writer : writers) {writer.join();}
+	done = true;
+	reader.join();
+	shared.flush();
+	if (misread) {return false;}
+
+	Model merged;
+	for (const Model &part : models) {merged.insert(part.begin(), part.end());}
+	return matches(*shared.read(), merged);
+}
+#endif // CONCURRENT_TEST
+
+#if defined(PERSISTENT_TEST) && (PERSISTENT_TEST != 0)
+/**
+ *	Snapshots of a persistent tree, which keep their version while the tree
+ *	changes. Then readers keep snapshots for several lookups while a writer
+ *	inserts keys in order, so each snapshot must hold exactly the first keys,
+ *	as many as its size.
+ */
+static bool checkPersistent() {
+	mt19937 rng(14);
+	PersistentAVLTree persistent;
+	Model current;
+	vector<pair<PersistentAVLTree::Snapshot, Model>> versions;
+	for (size_t i = 0; i < 5000; ++i) {
+		string key = keyOf(rng() % 1000);
+		if (rng() % 3) {
+			if (persistent.insert(key, i) != current.insert_or_assign(key, i).second) {return false;}
+		} else if (persistent.remove(key) != (current.erase(key) == 1)) {
+			return false;
+		}
+		if (i % 500 == 0) {versions.emplace_back(persistent.snapshot(), current);}
+	}
+	for (const auto &[snapshot, version] : versions) {
+		if (snapshot.size() != version.size() || snapshot.keys() != keysOf(version)) {return false;}
+		for (const auto &[key, value] : version) {
+			if (snapshot.get(key) != value) {return false;}
+		}
+	}
+
+	const size_t count = 20000;
+	PersistentAVLTree growing;
+	atomic<bool> torn = false;
+	vector<thread> readers;
+	for (size_t t = 0; t < 4; ++t) {
+		readers.emplace_back([&]() {
+			size_t last = 0;
+			while (last < count) {
+				PersistentAVLTree::Snapshot snapshot = growing.snapshot();
+				size_t size = snapshot.size();
+				bool whole = size >= last && !snapshot.contains(keyOf(size));
+				for (size_t j = 0; j < size; j += 1 + size / 8) {whole = whole && snapshot.get(keyOf(j)) == j;}
+				if (!whole) {torn = true;}
+				last = size;
+			}
+		});
+	}
+	for (size_t i = 0; i < count; ++i) {growing.insert(keyOf(i), i);}
+	for (thread &reader : readers) {reader.join();}
+	return !torn;
+}
+#endif // PERSISTENT_TEST
+
+#if defined(SHARDED_TEST) && (SHARDED_TEST != 0)
+/**
+ *	Merged keys and ranges of sharded trees, partitioned by hash and by range,
+ *	after writes through `operator[]`, `update()` and `remove()`. Then threads
+ *	increment shared counters through `update()`, none of which may be lost.
+ */
+static bool checkSharded() {
+	mt19937 rng(15);
+	ShardedAVLTree hashed(8);
+	ShardedAVLTree ranged(vector<string>{keyOf(2), keyOf(4), keyOf(6)});
+	for (ShardedAVLTree *tree : {&hashed, &ranged}) {
+		Model model;
+		for (size_t i = 0; i < 20000; ++i) {
+			string key = keyOf(rng() % 2000);
+			size_t value = rng() % 100;
+			switch (rng() % 3) {
+				case 0:
+					(*tree)[key] = value;
+					model[key] = value;
+					break;
+				case 1:
+					if (tree->update(key, [&](size_t &current) {current += value;}) == model.contains(key)) {return false;}
+					model[key] += value;
+					break;
+				default:
+					if (tree->remove(key) != (model.erase(key) == 1)) {return false;}
+					break;
+			}
+		}
+
+		if (tree->size() != model.size() || tree->keys() != keysOf(model)) {return false;}
+		for (size_t i = 0; i < 100; ++i) {
+			string low = keyOf(rng() % 2000), high = keyOf(rng() % 2000);
+			if (high < low) {swap(low, high);}
+			if (tree->findRange(low, high) != rangeOf(model, low, high)) {return false;}
+		}
+	}
+
+	const size_t threads = 4, increments = 20000;
+	vector<thread> writers;
+	for (size_t t = 0; t < threads; ++t) {
+		writers.emplace_back([&]() {
+			for (size_t i = 0; i < increments; ++i) {hashed.update("counter" + to_string(i % 100), [](size_t &count) {++count;});}
+		});
+	}
+	for (thread &writer : writers) {writer.join();}
+	for (size_t i = 0; i < 100; ++i) {
+		if (hashed.get("counter" + to_string(i)) != threads * increments / 100) {return false;}
+	}
+	return true;
+}
+#endif // SHARDED_TEST
+
+#if defined(BATCH_LOOKUP_TEST) && (BATCH_LOOKUP_TEST != 0)
+/**
+ *	`getBatch()` and `containsBatch()`, in the given order and sorted first,
+ *	with and without the hash index. Batches hold hits, misses and repeated
+ *	keys, and are sometimes too large for their output, which must then be
+ *	left as it was.
+ */
+static bool checkBatchLookups() {
+	mt19937 rng(16);
+	for (bool indexed : {false, true}) {
+		AVLTree tree;
+		tree.setHashIndex(indexed);
+		Model model;
+		if (!fill(tree, model, rng, 5000, 10000)) {return false;}
+
+		for (size_t round = 0; round < 200; ++round) {
+			vector<string> keys;
+			for (size_t i = 0, n = rng() % 300; i < n; ++i) {keys.push_back(keyOf(rng() % 12000));}
+			bool sortFirst = rng() % 2;
+			size_t room = (rng() % 10) ? keys.size() : keys.size() / 2;
+
+			vector<optional<size_t>> values(room, 7);
+			unique_ptr<bool[]> found(new bool[room]());
+			span<bool> flags(found.get(), room);
+			if (room < keys.size()) {
+				if (tree.getBatch(keys, values, sortFirst) || tree.containsBatch(keys, flags, sortFirst)) {return false;}
+				if (ranges::count(values, optional<size_t>(7)) != static_cast<ptrdiff_t>(room) || ranges::count(flags, true)) {return false;}
+				continue;
+			}
+
+			if (!tree.getBatch(keys, values, sortFirst) || !tree.containsBatch(keys, flags, sortFirst)) {return false;}
+			for (size_t i = 0; i < keys.size(); ++i) {
+				auto it = model.find(keys[i]);
+				bool hit = it != model.end();
+				if (found[i] != hit || values[i] != (hit ? optional<size_t>(it->second) : nullopt)) {return false;}
+			}
+		}
+	}
+	return true;
+}
+#endif // BATCH_LOOKUP_TEST
+
+#if defined(BATCH_TEST) && (BATCH_TEST != 0)
+/** Batch inserts and removals, and ranges removed with every combination of bounds. */
+static bool checkBatches() {
+	mt19937 rng(17);
+	AVLTree tree;
+	Model model;
+	for (size_t round = 0; round < 200; ++round) {
+		vector<pair<string, size_t>> pairs;
+		size_t added = 0;
+		for (size_t i = 0, n = rng() % 300; i < n; ++i) {
+			pairs.emplace_back(keyOf(rng() % 5000), rng() % 100);
+			added += model.insert_or_assign(pairs.back().first, pairs.back().second).second;
+		}
+		if (tree.insertBatch(pairs.begin(), pairs.end()) != added || !matches(tree, model)) {return false;}
+
+		vector<string> keys;
+		size_t removed = 0;
+		for (size_t i = 0, n = rng() % 200; i < n; ++i) {
+			keys.push_back(keyOf(rng() % 5000));
+			removed += model.erase(keys.back());
+		}
+		if (tree.removeBatch(keys.begin(), keys.end()) != removed || !matches(tree, model)) {return false;}
+
+		string low = keyOf(rng() % 5000), high = keyOf(rng() % 5000);
+		if (high < low) {swap(low, high);}
+		AVLTree::Bound lowBound = (rng() % 2) ? AVLTree::Bound::INCLUSIVE : AVLTree::Bound::EXCLUSIVE;
+		AVLTree::Bound highBound = (rng() % 2) ? AVLTree::Bound::INCLUSIVE : AVLTree::Bound::EXCLUSIVE;
+		auto first = (lowBound == AVLTree::Bound::INCLUSIVE) ? model.lower_bound(low) : model.upper_bound(low);
+		auto last = (highBound == AVLTree::Bound::INCLUSIVE) ? model.upper_bound(high) : model.lower_bound(high);
+		size_t inRange = (low < high || (lowBound == highBound && lowBound == AVLTree::Bound::INCLUSIVE)) ? distance(first, last) : 0;
+		if (inRange) {model.erase(first, last);}
+		if (tree.removeRange(low, high, lowBound, highBound) != inRange || !matches(tree, model)) {return false;}
+	}
+	return true;
+}
+#endif // BATCH_TEST
+
+#if defined(SET_ALGEBRA_TEST) && (SET_ALGEBRA_TEST != 0)
+/** Union, intersection, difference, split and both joins, on random pairs of trees. */
+static bool checkSetAlgebra() {
+	mt19937 rng(18);
+	for (size_t round = 0; round < 50; ++round) {
+		AVLTree a, b;
+		Model ma, mb;
+		if (!fill(a, ma, rng, 400, 1000) || !fill(b, mb, rng, 50 + round * 10, 1000)) {return false;}
+
+		AVLTree united(a);
+		Model mu = ma;
+		for (const auto &[key, value] : mb) {mu[key] = value;}
+		united.unionWith(b);
+		if (!matches(united, mu) || !matches(b, mb)) {return false;}
+
+		AVLTree common(a), rest(a);
+		Model mi, md;
+		for (const auto &[key, value] : ma) {(mb.contains(key) ? mi : md).emplace(key, value);}
+		if (common.intersect(b) != md.size() || !matches(common, mi)) {return false;}
+		if (rest.difference(b) != mi.size() || !matches(rest, md)) {return false;}
+
+		string pivot = keyOf(rng() % 1000);
+		AVLTree upper = a.split(pivot);
+		Model mupper(ma.lower_bound(pivot), ma.end());
+		Model mlower(ma.begin(), ma.lower_bound(pivot));
+		if (!matches(a, mlower) || !matches(upper, mupper)) {return false;}
+		if (!mupper.empty() && !mlower.empty() && upper.join(std::move(a))) {return false;}
+
+		if (upper.remove(pivot)) {
+			if (!a.join(pivot, ma[pivot], std::move(upper))) {return false;}
+		} else if (!a.join(std::move(upper))) {
+			return false;
+		}
+		if (!matches(a, ma) || !matches(upper, Model())) {return false;}
+	}
+	return true;
+}
+#endif // SET_ALGEBRA_TEST
+
+#if defined(PARALLEL_TEST) && (PARALLEL_TEST != 0)
+/**
+ *	Copies, bulk loads, unions and clears spread over a thread pool, with a
+ *	small cutoff so that even small trees are split across the threads. A
+ *	copy must not share nodes with its source, and a cleared tree must take
+ *	new keys again.
+ */
+static bool checkParallel() {
+	using Policy = AVLTree::DuplicatePolicy;
+	mt19937 rng(19);
+	ThreadPool pool(4);
+	for (size_t round = 0; round < 30; ++round) {
+		AVLTree a, b;
+		Model ma, mb;
+		if (!fill(a, ma, rng, 50 * round, 1000) || !fill(b, mb, rng, 400, 1000)) {return false;}
+
+		AVLTree copy(a, pool, 16);
+		Model mcopy = ma;
+		if (!matches(copy, mcopy) || !fill(copy, mcopy, rng, 100, 1000) || !matches(a, ma) || !matches(copy, mcopy)) {return false;}
+
+		Model mu = ma;
+		size_t added = 0;
+		for (const auto &[key, value] : mb) {added += mu.insert_or_assign(key, value).second;}
+		AVLTree other(b);
+		if (a.unionWith(std::move(other), pool, 16) != added || !matches(a, mu) || !matches(other, Model())) {return false;}
+
+		vector<pair<string, size_t>> pairs;
+		for (size_t i = 0, n = rng() % 2000; i < n; ++i) {pairs.emplace_back(keyOf(rng() % 3000), rng() % 100);}
+		if (round % 2) {stable_sort(pairs.begin(), pairs.end(), [](const auto &x, const auto &y) {return x.first < y.first;});}
+		Model first, last;
+		for (const auto &[key, value] : pairs) {
+			first.emplace(key, value);
+			last.insert_or_assign(key, value);
+		}
+		Policy policy = (round % 3 == 0) ? Policy::KEEP_LAST : Policy::KEEP_FIRST;
+		if (!b.bulkLoad(pairs.begin(), pairs.end(), pool, policy, 16)) {return false;}
+		if (!matches(b, (policy == Policy::KEEP_LAST) ? last : first)) {return false;}
+
+		b.clear(pool, 16);
+		mb.clear();
+		if (!matches(b, mb) || !fill(b, mb, rng, 100, 1000) || !matches(b, mb)) {return false;}
+	}
+	return true;
+}
+#endif // PARALLEL_TEST
+
+#if defined(SNAPSHOT_TEST) && (SNAPSHOT_TEST != 0)
+/**
+ *	A tree saved to a file and loaded again, and a mapped view of that file,
+ *	which stays valid while the tree is saved over it. Then two trees are saved
+ *	to the same file at once, which must leave one of them whole, and no
+ *	temporary file behind.
+ */
+static bool checkSnapshots() {
+	mt19937 rng(20);
+	string path = (filesystem::temp_directory_path() / "AVLTreeDebug.snapshot").string();
+	AVLTree tree;
+	Model model;
+	if (!fill(tree, model, rng, 3000, 10000) || !tree.save(path)) {return false;}
+
+	AVLTree loaded;
+	if (!loaded.load(path) || !matches(loaded, model)) {return false;}
+
+	MappedAVLTree view;
+	if (!view.open(path)) {return false;}
+	Model saved = model;
+	if (!fill(tree, model, rng, 1000, 10000) || !tree.save(path)) {return false;}
+
+	bool same = view.keys() == keysOf(saved);
+	for (const auto &[key, value] : saved) {same = same && view.get(key) == value;}
+	view.close();
+	filesystem::remove(path);
+	if (!same) {return false;}
+
+	filesystem::path directory = filesystem::temp_directory_path() / "AVLTreeDebug.snapshots";
+	filesystem::create_directory(directory);
+	path = (directory / "tree").string();
+	AVLTree other;
+	Model otherModel;
+	if (!fill(other, otherModel, rng, 3000, 10000)) {return false;}
+	for (size_t round = 0; round < 20; ++round) {
+		bool otherSaved = false;
+		thread writer([&]() {otherSaved = other.save(path);});
+		bool treeSaved = tree.save(path);
+		writer.join();
+		if (!treeSaved || !otherSaved || !loaded.load(path) || !(matches(loaded, model) || matches(loaded, otherModel))) {return false;}
+	}
+	size_t files = distance(filesystem::directory_iterator(directory), filesystem::directory_iterator());
+	filesystem::remove_all(directory);
+	return files == 1;
+}
+#endif // SNAPSHOT_TEST
+
+#if defined(FROZEN_TEST) && (FROZEN_TEST != 0)
+/**
+ *	Lookups, bounds and ranges of frozen trees. Their keys share prefixes of
+ *	several lengths, which a frozen tree skips, and the probes include keys
+ *	that stop within that prefix or leave it, and an empty key.
+ */
+static bool checkFrozen() {
+	mt19937 rng(22);
+	for (size_t round = 0; round < 60; ++round) {
+		string shared = string(round % 20, 'p');
+		auto frozenKey = [&](size_t i) {return shared + to_string(i);};
+		AVLTree tree;
+		Model model;
+		for (size_t i = 0, n = (round % 7) ? rng() % 2000 : round % 2; i < n; ++i) {
+			string key = frozenKey(rng() % 3000);
+			tree.insert(key, i);
+			model[key] = i;
+		}
+		FrozenAVLTree frozen = tree.freeze();
+
+		auto expected = model.begin();
+		for (const auto &entry : frozen) {
+			if (expected == model.end() || entry.key != expected->first || entry.value != expected->second) {return false;}
+			++expected;
+		}
+		if (expected != model.end() || frozen.size() != model.size()) {return false;}
+
+		auto same = [&](FrozenAVLTree::const_iterator it, Model::iterator at) {
+			return (it == frozen.end()) ? (at == model.end()) : (at != model.end() && it->key == at->first);
+		};
+		for (size_t i = 0; i < 500; ++i) {
+			string probe = frozenKey(rng() % 3500);
+			switch (rng() % 4) {
+				case 0: probe = shared.substr(0, rng() % (shared.size() + 1)); break;
+				case 1: probe = shared + "~"; break;
+				default: break;
+			}
+			auto found = model.find(probe);
+			optional<size_t> value;
+			if (found != model.end()) {value = found->second;}
+			if (frozen.contains(probe) != (found != model.end()) || frozen.get(probe) != value) {return false;}
+			if (frozen.get(string_view(probe)) != value) {return false;}
+			if (!same(frozen.lower_bound(probe), model.lower_bound(probe))) {return false;}
+			if (!same(frozen.upper_bound(probe), model.upper_bound(probe))) {return false;}
+
+			string high = frozenKey(rng() % 3500);
+			if (high < probe) {swap(probe, high);}
+			if (frozen.findRange(probe, high) != rangeOf(model, probe, high)) {return false;}
+		}
+	}
+	return true;
+}
+#endif // FROZEN_TEST
+
+#if defined(BPLUSTREE_TEST) && (BPLUSTREE_TEST != 0)
+/**
+ *	Removals from a B+ tree, which borrow keys from siblings and merge nodes
+ *	as they empty. Every node but the root keeps at least half a node of keys,
+ *	so a tree of height `h` holds at least `2 * minKeys^h` keys.
+ */
+static bool checkBPlusTree() {
+	mt19937 rng(23);
+	BPlusTree tree;
+	Model model;
+	for (size_t i = 0; i < 20000; ++i) {
+		string key = keyOf(rng() % 10000);
+		if (tree.insert(key, i) != model.insert_or_assign(key, i).second) {return false;}
+	}
+
+	vector<string> order;
+	for (const auto &[key, value] : model) {order.push_back(key);}
+	shuffle(order.begin(), order.end(), rng);
+	const size_t minKeys = BPlusTree::FANOUT / 2 - 1;
+	for (size_t i = 0; i < order.size(); ++i) {
+		if (!tree.remove(order[i]) || tree.remove(order[i])) {return false;}
+		model.erase(order[i]);
+		if (i % 97 != 0 && i + 1 != order.size()) {continue;}
+
+		if (tree.size() != model.size() || tree.keys() != keysOf(model)) {return false;}
+		if (!model.empty()) {
+			size_t fewest = 1;
+			for (size_t h = 0; h < tree.getHeight(); ++h) {fewest *= (h ? minKeys : 2 * minKeys);}
+			if (model.size() < fewest) {return false;}
+		}
+		for (const auto &[key, value] : model) {
+			if (tree.get(key) != value) {return false;}
+		}
+	}
+	return tree.size() == 0 && tree.getHeight() == static_cast<size_t>(-1);
+}
+#endif // BPLUSTREE_TEST
+
+#if defined(HASH_INDEX_TEST) && (HASH_INDEX_TEST != 0)
+/** Exact-match lookups of keys below `range`, which the hash index answers if the tree has one. */
+static bool indexAgrees(AVLTree &tree, const Model &model, mt19937 &rng, size_t range) {
+	if (!matches(tree, model)) {return false;}
+	for (size_t i = 0; i < 300; ++i) {
+		string key = keyOf(rng() % range);
+		auto found = model.find(key);
+		bool hit = found != model.end();
+		if (tree.contains(key) != hit || tree.contains(string_view(key)) != hit) {return false;}
+		if (tree.get(key) != (hit ? optional<size_t>(found->second) : nullopt)) {return false;}
+		AVLTree::iterator it = tree.find(string_view(key));
+		if (hit ? (it == tree.end() || it->key != key || it->value != found->second) : (it != tree.end())) {return false;}
+	}
+	return true;
+}
+
+/**
+ *	A tree with a hash index, changed through every kind of write, which must
+ *	keep the index in step with the nodes. The index is also turned off and on
+ *	again, and copied and moved with the tree.
+ */
+static bool checkHashIndex() {
+	mt19937 rng(24);
+	AVLTree tree;
+	tree.setHashIndex(true);
+	Model model;
+	for (size_t round = 0; round < 40; ++round) {
+		if (!fill(tree, model, rng, 300, 3000) || !indexAgrees(tree, model, rng, 4000)) {return false;}
+
+		for (size_t i = 0; i < 100; ++i) {
+			string key = keyOf(rng() % 3000);
+			if (tree.remove(key) != (model.erase(key) == 1)) {return false;}
+		}
+		if (!model.empty()) {
+			string assigned = next(model.begin(), rng() % model.size())->first;
+			tree[assigned] = round;
+			model[assigned] = round;
+		}
+
+		vector<pair<string, size_t>> pairs;
+		vector<string> keys;
+		for (size_t i = 0; i < 100; ++i) {
+			pairs.emplace_back(keyOf(rng() % 3000), i);
+			model.insert_or_assign(pairs.back().first, i);
+		}
+		tree.insertBatch(pairs.begin(), pairs.end());
+		for (size_t i = 0; i < 100; ++i) {
+			keys.push_back(keyOf(rng() % 3000));
+			model.erase(keys.back());
+		}
+		tree.removeBatch(keys.begin(), keys.end());
+		string low = keyOf(rng() % 3000), high = low + "5";
+		model.erase(model.lower_bound(low), model.upper_bound(high));
+		tree.removeRange(low, high);
+		if (!indexAgrees(tree, model, rng, 4000)) {return false;}
+
+		AVLTree other;
+		other.setHashIndex(rng() % 2);
+		Model otherModel;
+		if (!fill(other, otherModel, rng, 200, 3000)) {return false;}
+		switch (round % 3) {
+			case 0:
+				tree.unionWith(other);
+				for (const auto &[key, value] : otherModel) {model[key] = value;}
+				break;
+			case 1:
+				tree.intersect(other);
+				erase_if(model, [&](const auto &entry) {return !otherModel.contains(entry.first);});
+				break;
+			default:
+				tree.difference(other);
+				erase_if(model, [&](const auto &entry) {return otherModel.contains(entry.first);});
+				break;
+		}
+		if (!indexAgrees(tree, model, rng, 4000)) {return false;}
+
+		string pivot = keyOf(rng() % 3000);
+		AVLTree upper = tree.split(pivot);
+		Model upperModel(model.lower_bound(pivot), model.end());
+		model.erase(model.lower_bound(pivot), model.end());
+		if (!indexAgrees(tree, model, rng, 4000) || !indexAgrees(upper, upperModel, rng, 4000)) {return false;}
+		if (!tree.join(std::move(upper))) {return false;}
+		model.insert(upperModel.begin(), upperModel.end());
+
+		if (round % 5 == 0) {
+			tree.setHashIndex(false);
+			if (!indexAgrees(tree, model, rng, 4000)) {return false;}
+			tree.setHashIndex(true);
+		}
+		AVLTree copy(tree);
+		tree = std::move(copy);
+		if (!tree.hasHashIndex() || !indexAgrees(tree, model, rng, 4000)) {return false;}
+	}
+	tree.clear();
+	model.clear();
+	return indexAgrees(tree, model, rng, 4000) && fill(tree, model, rng, 100, 3000) && indexAgrees(tree, model, rng, 4000);
+}
+#endif // HASH_INDEX_TEST
+
+#if defined(LOOKUP_CACHE_TEST) && (LOOKUP_CACHE_TEST != 0)
+/**
+ *	Two trees with lookup caches, which share the cache of this thread, read
+ *	with skewed and with ascending keys while they are changed in every way
+ *	that moves or frees nodes. A cached node that was removed, or moved to
+ *	the other tree, must not be found again. Then several threads read one
+ *	tree at once, each through its own cache.
+ */
+static bool checkLookupCache() {
+	mt19937 rng(25);
+	AVLTree trees[2];
+	Model models[2];
+	for (size_t t = 0; t < 2; ++t) {
+		trees[t].setLookupCache(true);
+		if (!fill(trees[t], models[t], rng, 2000, 4000)) {return false;}
+	}
+
+	AVLTree::resetLookupCacheStats();
+	auto agrees = [&](size_t t, const string &key) {
+		auto found = models[t].find(key);
+		bool hit = found != models[t].end();
+		return trees[t].contains(key) == hit && trees[t].get(key) == (hit ? optional<size_t>(found->second) : nullopt);
+	};
+	for (size_t round = 0; round < 200; ++round) {
+		for (size_t i = 0; i < 500; ++i) {
+			size_t t = rng() % 2;
+			size_t index = (rng() % 4) ? rng() % 32 : rng() % 4000;
+			if (!agrees(t, keyOf(index))) {return false;}
+		}
+		for (size_t i = 0; i < 200; ++i) {
+			if (!agrees(round % 2, keyOf(1000 + round + i))) {return false;}
+		}
+
+		size_t t = rng() % 2;
+		AVLTree &tree = trees[t];
+		Model &model = models[t];
+		string key = keyOf(rng() % 32);
+		switch (round % 6) {
+			case 0:
+				if (tree.remove(key) != (model.erase(key) == 1)) {return false;}
+				break;
+			case 1:
+				if (tree.insert(key, round) != model.insert_or_assign(key, round).second) {return false;}
+				break;
+			case 2: {
+				string high = keyOf(rng() % 32);
+				if (high < key) {swap(key, high);}
+				model.erase(model.lower_bound(key), model.upper_bound(high));
+				tree.removeRange(key, high);
+				break;
+			}
+			case 3: {
+				AVLTree upper = tree.split(key);
+				Model upperModel(model.lower_bound(key), model.end());
+				model.erase(model.lower_bound(key), model.end());
+				trees[1 - t].unionWith(std::move(upper));
+				for (const auto &[movedKey, value] : upperModel) {models[1 - t][movedKey] = value;}
+				break;
+			}
+			case 4:
+				if (!fill(tree, model, rng, 300, 4000)) {return false;}
+				break;
+			default:
+				if (round % 60 == 5) {
+					tree.clear();
+					model.clear();
+				}
+				break;
+		}
+		if (!matches(trees[0], models[0]) || !matches(trees[1], models[1])) {return false;}
+	}
+	LookupCacheStats stats = AVLTree::lookupCacheStats();
+	if (stats.hits == 0 || stats.fingerStarts == 0) {return false;}
+
+	atomic<bool> wrong = false;
+	vector<thread> readers;
+	for (size_t r = 0; r < 4; ++r) {
+		readers.emplace_back([&, r]() {
+			mt19937 readRng(250 + r);
+			for (size_t i = 0; i < 20000; ++i) {
+				string key = keyOf((readRng() % 4) ? readRng() % 32 : readRng() % 4000);
+				auto found = models[0].find(key);
+				if (trees[0].get(key) != ((found != models[0].end()) ? optional<size_t>(found->second) : nullopt)) {wrong = true;}
+			}
+		});
+	}
+	for (thread &reader : readers) {reader.join();}
+	return !wrong;
+}
+#endif // LOOKUP_CACHE_TEST
 
 int main() {
 #if defined(RUN_TEST) && (RUN_TEST != 0)
@@ -145,5 +1111,69 @@ int main() {
 #endif // MEMLEAK_TEST
 #endif // RUN_TEST
 
-	return 0;
+#if defined(ITERATOR_TEST) && (ITERATOR_TEST != 0)
+	report("iterators and bounds", checkIterators());
+#endif // ITERATOR_TEST
+
+#if defined(EMPLACE_TEST) && (EMPLACE_TEST != 0)
+	report("emplace", checkEmplace());
+#endif // EMPLACE_TEST
+
+#if defined(BULKLOAD_TEST) && (BULKLOAD_TEST != 0)
+	report("bulk load", checkBulkLoad());
+#endif // BULKLOAD_TEST
+
+#if defined(COMPACT_TEST) && (COMPACT_TEST != 0)
+	report("compact tree", checkCompact());
+#endif // COMPACT_TEST
+
+#if defined(CONCURRENT_TEST) && (CONCURRENT_TEST != 0)
+	report("concurrent tree", checkConcurrent());
+#endif // CONCURRENT_TEST
+
+#if defined(PERSISTENT_TEST) && (PERSISTENT_TEST != 0)
+	report("persistent snapshots", checkPersistent());
+#endif // PERSISTENT_TEST
+
+#if defined(SHARDED_TEST) && (SHARDED_TEST != 0)
+	report("sharded trees", checkSharded());
+#endif // SHARDED_TEST
+
+#if defined(BATCH_LOOKUP_TEST) && (BATCH_LOOKUP_TEST != 0)
+	report("batch lookups", checkBatchLookups());
+#endif // BATCH_LOOKUP_TEST
+
+#if defined(BATCH_TEST) && (BATCH_TEST != 0)
+	report("batches and ranges", checkBatches());
+#endif // BATCH_TEST
+
+#if defined(SET_ALGEBRA_TEST) && (SET_ALGEBRA_TEST != 0)
+	report("set algebra", checkSetAlgebra());
+#endif // SET_ALGEBRA_TEST
+
+#if defined(PARALLEL_TEST) && (PARALLEL_TEST != 0)
+	report("parallel operations", checkParallel());
+#endif // PARALLEL_TEST
+
+#if defined(SNAPSHOT_TEST) && (SNAPSHOT_TEST != 0)
+	report("saved snapshots", checkSnapshots());
+#endif // SNAPSHOT_TEST
+
+#if defined(FROZEN_TEST) && (FROZEN_TEST != 0)
+	report("frozen trees", checkFrozen());
+#endif // FROZEN_TEST
+
+#if defined(BPLUSTREE_TEST) && (BPLUSTREE_TEST != 0)
+	report("B+ tree removal", checkBPlusTree());
+#endif // BPLUSTREE_TEST
+
+#if defined(HASH_INDEX_TEST) && (HASH_INDEX_TEST != 0)
+	report("hash index", checkHashIndex());
+#endif // HASH_INDEX_TEST
+
+#if defined(LOOKUP_CACHE_TEST) && (LOOKUP_CACHE_TEST != 0)
+	report("lookup cache", checkLookupCache());
+#endif // LOOKUP_CACHE_TEST
+
+	return failed ? 1 : 0;
 }
@@ -0,0 +1,682 @@
+/**
+ *	BPlusTree.cpp
+ */
+
+#include "BPlusTree.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <unordered_set>
+#include <utility>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/** The number of packed prefixes that are less than the search key, and the number that are not greater. */
+struct Rank {
+	size_t less;
+	size_t notGreater;
+};
+
+using RankKernel = Rank (*)(const int64_t *prefixes, size_t count, int64_t probe);
+
+/** The masks of the vector kernels hold one bit per key. */
+static_assert(BPlusTree::FANOUT <= 64 && BPlusTree::FANOUT % 4 == 0);
+
+Rank rankScalar(const int64_t *prefixes, size_t count, int64_t probe) {
+	Rank rank{0, 0};
+	for (size_t i = 0; i < count; ++i) {
+		rank.less += prefixes[i] < probe;
+		rank.notGreater += prefixes[i] <= probe;
+	}
+	return rank;
+}
+
+/**
+ *	Builds the ranks from one bit per key for the keys that are less than the
+ *	search key, and one for those that are equal. The lanes past `count` hold
+ *	stale bytes, so their bits are masked off.
+ */
+Rank rankOfMasks(uint64_t less, uint64_t equal, size_t count) {
+	uint64_t valid = (count < 64) ? (uint64_t{1} << count) - 1 : ~uint64_t{0};
+	size_t below = std::popcount(less & valid);
+	return {below, below + std::popcount(equal & valid)};
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/** SSE2 has no 64-bit compares, so the narrow kernel needs SSE4.2. */
+__attribute__((target("sse4.2")))
+Rank rankSse42(const int64_t *prefixes, size_t count, int64_t probe) {
+	__m128i needle = _mm_set1_epi64x(probe);
+	uint64_t less = 0;
+	uint64_t equal = 0;
+	for (size_t i = 0; i < count; i += 2) {
+		__m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(prefixes + i));
+		less |= static_cast<uint64_t>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(needle, lanes)))) << i;
+		equal |= static_cast<uint64_t>(_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(needle, lanes)))) << i;
+	}
+	return rankOfMasks(less, equal, count);
+}
+
+__attribute__((target("avx2")))
+Rank rankAvx2(const int64_t *prefixes, size_t count, int64_t probe) {
+	__m256i needle = _mm256_set1_epi64x(probe);
+	uint64_t less = 0;
+	uint64_t equal = 0;
+	for (size_t i = 0; i < count; i += 4) {
+		__m256i lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(prefixes + i));
+		less |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(needle, lanes)))) << i;
+		equal |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(needle, lanes)))) << i;
+	}
+	return rankOfMasks(less, equal, count);
+}
+
+#endif
+
+struct SearchKernel {
+	const char *name;
+	RankKernel rank;
+};
+
+SearchKernel chooseKernel() {
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {return {"avx2", rankAvx2};}
+	if (__builtin_cpu_supports("sse4.2")) {return {"sse4.2", rankSse42};}
+#endif
+	return {"scalar", rankScalar};
+}
+
+/** Picked on first use rather than at static initialization, so trees in other static objects can use it. */
+const SearchKernel & searchKernelOf() {
+	static const SearchKernel chosen = chooseKernel();
+	return chosen;
+}
+
+/** The number of leading bytes that two keys share. */
+size_t sharedLength(std::string_view a, std::string_view b) {
+	return std::mismatch(a.begin(), a.end(), b.begin(), b.end()).first - a.begin();
+}
+
+}
+
+BPlusTree::BPlusTree() :
+	root(BPlusTree::createLeaf()), length(0), height(0) {}
+
+/**
+ *	Copies every node of the other tree, relinking the copied leaves in order.
+ *
+ *	Expected time complexity is `O(n)`.
+ */
+BPlusTree::BPlusTree(const BPlusTree &other) :
+	length(other.length), height(other.height) {
+	Leaf *previous = nullptr;
+	this->root = BPlusTree::copyNode(*other.root, previous);
+}
+
+/** Leaves the other tree empty. */
+BPlusTree::BPlusTree(BPlusTree &&other) noexcept :
+	root(std::exchange(other.root, BPlusTree::createLeaf())),
+	length(std::exchange(other.length, 0)), height(std::exchange(other.height, 0)) {}
+
+BPlusTree::~BPlusTree() {
+	BPlusTree::destroyNode(this->root);
+}
+
+BPlusTree & BPlusTree::operator=(BPlusTree other) noexcept {
+	std::swap(this->root, other.root);
+	std::swap(this->length, other.length);
+	std::swap(this->height, other.height);
+	return *this;
+}
+
+/**
+ *	Packs the first `PREFIX_BYTES` bytes into an integer, with the first byte
+ *	as the most significant one, and flips its sign bit. Shorter byte strings
+ *	are padded with zeros. Comparing two packed prefixes as signed integers
+ *	then orders them like comparing the bytes.
+ */
+int64_t BPlusTree::prefixOf(std::string_view bytes) {
+	unsigned char packed[PREFIX_BYTES] = {};
+	std::memcpy(packed, bytes.data(), std::min(bytes.size(), PREFIX_BYTES));
+
+	uint64_t prefix = 0;
+	for (unsigned char byte : packed) {
+		prefix = (prefix << 8) | byte;
+	}
+	return static_cast<int64_t>(prefix ^ (uint64_t{1} << 63));
+}
+
+/**
+ *	Returns the number of keys in the node that are less than `key`, or not
+ *	greater than `key` if `upper` is set.
+ *
+ *	A search key without the shared prefix of the node is below or above all
+ *	of its keys. Otherwise the packed bytes after that prefix rank the search
+ *	key among the keys, except among those whose packed bytes are equal to its
+ *	own, which are ordered by the rest of their bytes.
+ */
+size_t BPlusTree::rankOf(const Node &node, std::string_view key, bool upper) {
+	if (node.count == 0) {
+		return 0;
+	}
+
+	int cmp = key.compare(0, node.shared, node.keys[0], 0, node.shared);
+	if (cmp != 0) {
+		return (cmp < 0) ? 0 : node.count;
+	}
+
+	std::string_view rest = key.substr(node.shared);
+	Rank rank = searchKernelOf().rank(node.prefixes, node.count, BPlusTree::prefixOf(rest));
+
+	size_t first = rank.less;
+	size_t last = rank.notGreater;
+	while (first < last) {
+		size_t middle = first + (last - first) / 2;
+		int order = std::string_view(node.keys[middle]).substr(node.shared).compare(rest);
+		if (order < 0 || (upper && order == 0)) {
+			first = middle + 1;
+		} else {
+			last = middle;
+		}
+	}
+	return first;
+}
+
+/**
+ *	Descends from the root to the leaf where `key` is or would be. The first
+ *	cache lines of each child are prefetched together, before any of them is
+ *	read, since the search needs all of them.
+ */
+const BPlusTree::Leaf & BPlusTree::leafOf(std::string_view key) const {
+	/** The header, the packed prefixes and the first key, which holds the shared prefix. */
+	constexpr size_t SEARCHED_BYTES = sizeof(Node) - sizeof(Node::keys) + sizeof(KeyType);
+
+	const Node *node = this->root;
+	while (!node->leaf) {
+		node = static_cast<const Inner *>(node)->children[BPlusTree::rankOf(*node, key, true)];
+		const char *bytes = reinterpret_cast<const char *>(node);
+		for (size_t offset = 0; offset < SEARCHED_BYTES; offset += 64) {
+			__builtin_prefetch(bytes + offset);
+		}
+	}
+	return *static_cast<const Leaf *>(node);
+}
+
+/**
+ *	Inserts the key-value pair into the tree.
+ *	If the key already exists, its value is updated, and this returns `false`.
+ *
+ *	A full node is split in two halves, which may split its parent in turn.
+ *	If the root is split, the tree grows a new root above it.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+bool BPlusTree::insert(std::string_view key, ValueType value) {
+	std::optional<Split> split;
+	if (!this->insert(*this->root, key, value, split)) {
+		return false;
+	}
+
+	if (split) {
+		Inner *top = BPlusTree::createInner();
+		top->children[0] = this->root;
+		top->children[1] = split->right;
+		BPlusTree::insertKey(*top, 0, std::move(split->separator));
+		this->root = top;
+		++this->height;
+	}
+	++this->length;
+	return true;
+}
+
+bool BPlusTree::insert(Node &node, std::string_view key, ValueType value, std::optional<Split> &split) {
+	if (node.leaf) {
+		Leaf *leaf = static_cast<Leaf *>(&node);
+		size_t pos = BPlusTree::rankOf(node, key, false);
+		if (pos < node.count && node.keys[pos] == key) {
+			leaf->values[pos] = value;
+			return false;
+		}
+
+		if (node.count == FANOUT) {
+			Leaf *right = BPlusTree::createLeaf();
+			size_t half = FANOUT / 2;
+			std::move(leaf->keys + half, leaf->keys + FANOUT, right->keys);
+			std::copy(leaf->values + half, leaf->values + FANOUT, right->values);
+			right->count = FANOUT - half;
+			right->next = leaf->next;
+			leaf->count = half;
+			leaf->next = right;
+			BPlusTree::repack(*leaf);
+			BPlusTree::repack(*right);
+			split = Split{right->keys[0], right};
+
+			if (pos > half) {
+				leaf = right;
+				pos -= half;
+			}
+		}
+
+		std::copy_backward(leaf->values + pos, leaf->values + leaf->count, leaf->values + leaf->count + 1);
+		leaf->values[pos] = value;
+		BPlusTree::insertKey(*leaf, pos, KeyType(key));
+		return true;
+	}
+
+	Inner *inner = static_cast<Inner *>(&node);
+	size_t i = BPlusTree::rankOf(node, key, true);
+	std::optional<Split> childSplit;
+	if (!this->insert(*inner->children[i], key, value, childSplit)) {
+		return false;
+	}
+	if (!childSplit) {
+		return true;
+	}
+
+	/**	The middle key of a full inner node moves up to the parent, and the
+	 *	separator from the child goes to whichever half it falls in. */
+	if (node.count == FANOUT) {
+		Inner *right = BPlusTree::createInner();
+		size_t half = FANOUT / 2;
+		std::move(inner->keys + half + 1, inner->keys + FANOUT, right->keys);
+		std::copy(inner->children + half + 1, inner->children + FANOUT + 1, right->children);
+		right->count = FANOUT - half - 1;
+		inner->count = half;
+		BPlusTree::repack(*inner);
+		BPlusTree::repack(*right);
+		split = Split{std::move(inner->keys[half]), right};
+
+		if (i > half) {
+			inner = right;
+			i -= half + 1;
+		}
+	}
+
+	std::copy_backward(inner->children + i + 1, inner->children + inner->count + 1, inner->children + inner->count + 2);
+	inner->children[i + 1] = childSplit->right;
+	BPlusTree::insertKey(*inner, i, std::move(childSplit->separator));
+	return true;
+}
+
+/**
+ *	If `key` exists in the tree, that key-value pair is removed, and this
+ *	returns `true`. Otherwise, the tree is not modified.
+ *
+ *	A node left with less than `MIN_KEYS` keys takes one from a sibling, or
+ *	is merged with it if the sibling has none to spare. If the root is left
+ *	with a single child, that child becomes the root.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+bool BPlusTree::remove(std::string_view key) {
+	if (!this->remove(*this->root, key)) {
+		return false;
+	}
+
+	if (!this->root->leaf && this->root->count == 0) {
+		Inner *top = static_cast<Inner *>(this->root);
+		this->root = top->children[0];
+		delete top;
+		--this->height;
+	}
+	--this->length;
+	return true;
+}
+
+bool BPlusTree::remove(Node &node, std::string_view key) {
+	if (node.leaf) {
+		Leaf &leaf = static_cast<Leaf &>(node);
+		size_t pos = BPlusTree::rankOf(node, key, false);
+		if (pos == node.count || node.keys[pos] != key) {
+			return false;
+		}
+
+		std::copy(leaf.values + pos + 1, leaf.values + leaf.count, leaf.values + pos);
+		BPlusTree::eraseKey(leaf, pos);
+		return true;
+	}
+
+	Inner &inner = static_cast<Inner &>(node);
+	size_t i = BPlusTree::rankOf(node, key, true);
+	if (!this->remove(*inner.children[i], key)) {
+		return false;
+	}
+	if (inner.children[i]->count < MIN_KEYS) {
+		this->rebalanceChild(inner, i);
+	}
+	return true;
+}
+
+/** Refills the child at `i`, which has one key less than `MIN_KEYS`, from one of its siblings. */
+void BPlusTree::rebalanceChild(Inner &parent, size_t i) {
+	if (i > 0 && parent.children[i - 1]->count > MIN_KEYS) {
+		this->borrowFromLeft(parent, i);
+	} else if (i < parent.count && parent.children[i + 1]->count > MIN_KEYS) {
+		this->borrowFromRight(parent, i);
+	} else {
+		this->merge(parent, (i > 0) ? i - 1 : i);
+	}
+}
+
+/** Moves the last key of the left sibling of the child at `i` to that child. */
+void BPlusTree::borrowFromLeft(Inner &parent, size_t i) {
+	Node &left = *parent.children[i - 1];
+	Node &child = *parent.children[i];
+	size_t last = left.count - 1;
+
+	if (child.leaf) {
+		Leaf &from = static_cast<Leaf &>(left);
+		Leaf &to = static_cast<Leaf &>(child);
+		std::copy_backward(to.values, to.values + to.count, to.values + to.count + 1);
+		to.values[0] = from.values[last];
+		BPlusTree::insertKey(to, 0, std::move(from.keys[last]));
+		BPlusTree::eraseKey(from, last);
+		BPlusTree::replaceKey(parent, i - 1, to.keys[0]);
+	} else {
+		Inner &from = static_cast<Inner &>(left);
+		Inner &to = static_cast<Inner &>(child);
+		std::copy_backward(to.children, to.children + to.count + 1, to.children + to.count + 2);
+		to.children[0] = from.children[last + 1];
+		BPlusTree::insertKey(to, 0, KeyType(parent.keys[i - 1]));
+		BPlusTree::replaceKey(parent, i - 1, from.keys[last]);
+		BPlusTree::eraseKey(from, last);
+	}
+}
+
+/** Moves the first key of the right sibling of the child at `i` to that child. */
+void BPlusTree::borrowFromRight(Inner &parent, size_t i) {
+	Node &child = *parent.children[i];
+	Node &right = *parent.children[i + 1];
+
+	if (child.leaf) {
+		Leaf &to = static_cast<Leaf &>(child);
+		Leaf &from = static_cast<Leaf &>(right);
+		to.values[to.count] = from.values[0];
+		BPlusTree::insertKey(to, to.count, std::move(from.keys[0]));
+		std::copy(from.values + 1, from.values + from.count, from.values);
+		BPlusTree::eraseKey(from, 0);
+		BPlusTree::replaceKey(parent, i, from.keys[0]);
+	} else {
+		Inner &to = static_cast<Inner &>(child);
+		Inner &from = static_cast<Inner &>(right);
+		to.children[to.count + 1] = from.children[0];
+		BPlusTree::insertKey(to, to.count, KeyType(parent.keys[i]));
+		BPlusTree::replaceKey(parent, i, from.keys[0]);
+		std::copy(from.children + 1, from.children + from.count + 1, from.children);
+		BPlusTree::eraseKey(from, 0);
+	}
+}
+
+/**
+ *	Moves every key of the child at `i + 1` into the child at `i`, and
+ *	removes the emptied child and its separator from the parent. Between two
+ *	inner nodes, the separator moves down to join their keys.
+ */
+void BPlusTree::merge(Inner &parent, size_t i) {
+	Node &left = *parent.children[i];
+	Node *right = parent.children[i + 1];
+
+	if (left.leaf) {
+		Leaf &to = static_cast<Leaf &>(left);
+		Leaf &from = *static_cast<Leaf *>(right);
+		std::move(from.keys, from.keys + from.count, to.keys + to.count);
+		std::copy(from.values, from.values + from.count, to.values + to.count);
+		to.count += from.count;
+		to.next = from.next;
+		delete &from;
+	} else {
+		Inner &to = static_cast<Inner &>(left);
+		Inner &from = *static_cast<Inner *>(right);
+		to.keys[to.count] = std::move(parent.keys[i]);
+		std::move(from.keys, from.keys + from.count, to.keys + to.count + 1);
+		std::copy(from.children, from.children + from.count + 1, to.children + to.count + 1);
+		to.count += from.count + 1;
+		delete &from;
+	}
+	BPlusTree::repack(left);
+
+	std::copy(parent.children + i + 2, parent.children + parent.count + 1, parent.children + i + 1);
+	BPlusTree::eraseKey(parent, i);
+}
+
+/**
+ *	Recomputes the prefix that all keys of the node share, which is the one
+ *	that its first and last key share, and packs the bytes after it.
+ */
+void BPlusTree::repack(Node &node) {
+	if (node.count == 0) {
+		node.shared = 0;
+		return;
+	}
+
+	node.shared = sharedLength(node.keys[0], node.keys[node.count - 1]);
+	for (size_t i = 0; i < node.count; ++i) {
+		node.prefixes[i] = BPlusTree::prefixOf(std::string_view(node.keys[i]).substr(node.shared));
+	}
+}
+
+/**
+ *	Inserts a key at `pos` in the node, which has room for it. The keys only
+ *	need to be packed again if the new key shortens their shared prefix.
+ */
+void BPlusTree::insertKey(Node &node, size_t pos, KeyType &&key) {
+	std::move_backward(node.keys + pos, node.keys + node.count, node.keys + node.count + 1);
+	std::copy_backward(node.prefixes + pos, node.prefixes + node.count, node.prefixes + node.count + 1);
+	++node.count;
+
+	size_t shared = (node.count == 1) ? key.size() : std::min<size_t>(node.shared, sharedLength(key, node.keys[(pos == 0) ? 1 : 0]));
+	node.keys[pos] = std::move(key);
+	if (shared != node.shared) {
+		BPlusTree::repack(node);
+	} else {
+		node.prefixes[pos] = BPlusTree::prefixOf(std::string_view(node.keys[pos]).substr(shared));
+	}
+}
+
+/** Removing the first or last key may lengthen the shared prefix, so the keys are packed again. */
+void BPlusTree::eraseKey(Node &node, size_t pos) {
+	std::move(node.keys + pos + 1, node.keys + node.count, node.keys + pos);
+	std::copy(node.prefixes + pos + 1, node.prefixes + node.count, node.prefixes + pos);
+	--node.count;
+	node.keys[node.count].clear();
+
+	if (pos == 0 || pos == node.count) {
+		BPlusTree::repack(node);
+	}
+}
+
+/** Replaces a key by another one that keeps the keys of the node in order. */
+void BPlusTree::replaceKey(Node &node, size_t pos, const KeyType &key) {
+	node.keys[pos] = key;
+	if (pos == 0 || pos + 1 == node.count) {
+		BPlusTree::repack(node);
+	} else {
+		node.prefixes[pos] = BPlusTree::prefixOf(std::string_view(node.keys[pos]).substr(node.shared));
+	}
+}
+
+BPlusTree::Leaf * BPlusTree::createLeaf() {
+	Leaf *leaf = new Leaf();
+	leaf->leaf = true;
+	return leaf;
+}
+
+BPlusTree::Inner * BPlusTree::createInner() {
+	return new Inner();
+}
+
+/**
+ *	Returns `true` if and only if the specified `key` is in the tree.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+bool BPlusTree::contains(std::string_view key) const {
+	const Leaf &leaf = this->leafOf(key);
+	size_t pos = BPlusTree::rankOf(leaf, key, false);
+	return pos < leaf.count && leaf.keys[pos] == key;
+}
+
+/**
+ *	Returns the value associated with the specified `key`, or nothing if the
+ *	key is not in the tree.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+std::optional<BPlusTree::ValueType> BPlusTree::get(std::string_view key) const {
+	const Leaf &leaf = this->leafOf(key);
+	size_t pos = BPlusTree::rankOf(leaf, key, false);
+	if (pos < leaf.count && leaf.keys[pos] == key) {
+		return leaf.values[pos];
+	}
+	return std::nullopt;
+}
+
+/**
+ *	Returns a vector of every key in the tree, in ascending order.
+ *
+ *	Expected time complexity is `O(n)`.
+ */
+std::vector<BPlusTree::KeyType> BPlusTree::keys() const {
+	std::vector<KeyType> keyList;
+	keyList.reserve(this->length);
+
+	const Node *node = this->root;
+	while (!node->leaf) {node = static_cast<const Inner *>(node)->children[0];}
+	for (const Leaf *leaf = static_cast<const Leaf *>(node); leaf; leaf = leaf->next) {
+		keyList.insert(keyList.end(), leaf->keys, leaf->keys + leaf->count);
+	}
+	return keyList;
+}
+
+/**
+ *	Returns the values of the keys in `[low, high]`, in ascending order of the
+ *	keys. Like `AVLTree::findRange`, a value that occurs more than once is
+ *	only returned the first time.
+ *
+ *	Expected time complexity is `O(log(n) + k)` for `k` pairs in the range.
+ */
+std::vector<BPlusTree::ValueType> BPlusTree::findRange(std::string_view low, std::string_view high) const {
+	std::vector<ValueType> valueList;
+	std::unordered_set<ValueType> seen;
+	this->visitRange(low, high, [&](const KeyType &, ValueType value) {
+		if (seen.insert(value).second) {valueList.push_back(value);}
+	});
+	return valueList;
+}
+
+/**
+ *	Returns the number of key-value pairs in the tree.
+ *
+ *	Expected time complexity is `O(1)`.
+ */
+size_t BPlusTree::size() const {return this->length;}
+
+/**
+ *	Returns the number of edges from the root to the leaves, which are all at
+ *	the same depth, or `-1` cast to `size_t` if the tree is empty.
+ *
+ *	Expected time complexity is `O(1)`.
+ */
+size_t BPlusTree::getHeight() const {
+	return (this->length == 0) ? static_cast<size_t>(-1) : this->height;
+}
+
+/** Removes every key-value pair. */
+void BPlusTree::clear() {
+	BPlusTree::destroyNode(this->root);
+	this->root = BPlusTree::createLeaf();
+	this->length = 0;
+	this->height = 0;
+}
+
+/**
+ *	Returns the number of bytes held by the tree, including the key bytes
+ *	that don't fit inside a `std::string`.
+ *
+ *	Expected time complexity is `O(n)`.
+ */
+size_t BPlusTree::memoryUsage() const {
+	return sizeof(*this) + BPlusTree::memoryUsage(*this->root);
+}
+
+size_t BPlusTree::memoryUsage(const Node &node) {
+	/** The capacity of an empty string is what fits inside the string itself. */
+	static const size_t INLINE_CAPACITY = KeyType().capacity();
+
+	size_t bytes = node.leaf ? sizeof(Leaf) : sizeof(Inner);
+	for (size_t i = 0; i < node.count; ++i) {
+		if (node.keys[i].capacity() > INLINE_CAPACITY) {bytes += node.keys[i].capacity() + 1;}
+	}
+	if (!node.leaf) {
+		const Inner &inner = static_cast<const Inner &>(node);
+		for (size_t i = 0; i <= node.count; ++i) {bytes += BPlusTree::memoryUsage(*inner.children[i]);}
+	}
+	return bytes;
+}
+
+/** The name of the vector instructions that nodes are searched with: `"avx2"`, `"sse4.2"` or `"scalar"`. */
+const char * BPlusTree::searchKernel() {
+	return searchKernelOf().name;
+}
+
+BPlusTree::Node * BPlusTree::copyNode(const Node &node, Leaf *&previous) {
+	if (node.leaf) {
+		const Leaf &leaf = static_cast<const Leaf &>(node);
+		Leaf *copy = new Leaf(leaf);
+		copy->next = nullptr;
+		if (previous) {previous->next = copy;}
+		previous = copy;
+		return copy;
+	}
+
+	const Inner &inner = static_cast<const Inner &>(node);
+	Inner *copy = new Inner(inner);
+	for (size_t i = 0; i <= inner.count; ++i) {
+		copy->children[i] = BPlusTree::copyNode(*inner.children[i], previous);
+	}
+	return copy;
+}
+
+void BPlusTree::destroyNode(Node *node) {
+	if (node->leaf) {
+		delete static_cast<Leaf *>(node);
+		return;
+	}
+
+	Inner *inner = static_cast<Inner *>(node);
+	for (size_t i = 0; i <= inner->count; ++i) {BPlusTree::destroyNode(inner->children[i]);}
+	delete inner;
+}
+
+/**
+ *	Prints every node of the tree, one per line and indented by its depth,
+ *	with the separators of inner nodes in brackets and the pairs of leaves in
+ *	braces.
+ */
+std::ostream & operator<<(std::ostream &os, const BPlusTree &tree) {
+	BPlusTree::printDepth(os, *tree.root, 0);
+	return os;
+}
+
+void BPlusTree::printDepth(std::ostream &os, const Node &node, size_t depth) {
+	os << std::string(2 * depth, ' ');
+	if (node.leaf) {
+		const Leaf &leaf = static_cast<const Leaf &>(node);
+		os << "{";
+		for (size_t i = 0; i < leaf.count; ++i) {
+			os << ((i > 0) ? ", " : "") << leaf.keys[i] << ": " << leaf.values[i];
+		}
+		os << "}\n";
+		return;
+	}
+
+	const Inner &inner = static_cast<const Inner &>(node);
+	os << "[";
+	for (size_t i = 0; i < inner.count; ++i) {os << ((i > 0) ? " | " : "") << inner.keys[i];}
+	os << "]\n";
+	for (size_t i = 0; i <= inner.count; ++i) {BPlusTree::printDepth(os, *inner.children[i], depth + 1);}
+}
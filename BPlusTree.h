@@ -0,0 +1,160 @@
+/**
+ *	BPlusTree.h
+ */
+
+#ifndef BPLUSTREE_H
+#define BPLUSTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ *	A B+ tree of `std::string` keys and `size_t` values, with the same
+ *	interface as `CompactAVLTree`, for comparing wide nodes with binary ones.
+ *
+ *	Each node holds up to `FANOUT` keys in ascending order. Inner nodes route
+ *	between their children, and only the leaves hold values; the leaves are
+ *	linked in key order, so range scans don't go back up the tree.
+ *
+ *	All keys of a node share their longest common prefix, which is taken once
+ *	for the whole node. The next `PREFIX_BYTES` bytes of every key are packed
+ *	into integers, stored side by side, so that one node is searched by
+ *	comparing the packed bytes of the search key with all of them at once. This
+ *	uses AVX2 or SSE4.2 vector compares if the CPU has them, which is checked
+ *	once at run time, or a scalar loop otherwise. Only keys whose packed bytes
+ *	equal those of the search key are compared as strings.
+ */
+class BPlusTree {
+	public:
+		using KeyType = std::string;
+		using ValueType = size_t;
+
+		static constexpr size_t FANOUT = 32;
+		static constexpr size_t PREFIX_BYTES = 8;
+
+		BPlusTree();
+		BPlusTree(const BPlusTree &other);
+		BPlusTree(BPlusTree &&other) noexcept;
+		~BPlusTree();
+
+		BPlusTree & operator=(BPlusTree other) noexcept;
+
+		bool insert(std::string_view key, ValueType value);
+		bool remove(std::string_view key);
+		bool contains(std::string_view key) const;
+		std::optional<ValueType> get(std::string_view key) const;
+
+		std::vector<KeyType> keys() const;
+		std::vector<ValueType> findRange(std::string_view low, std::string_view high) const;
+
+		template <typename Visitor>
+		void visitRange(std::string_view low, std::string_view high, Visitor &&visit) const;
+
+		size_t size() const;
+		size_t getHeight() const;
+
+		void clear();
+		size_t memoryUsage() const;
+
+		static const char * searchKernel();
+
+		friend std::ostream & operator<<(std::ostream &os, const BPlusTree &tree);
+
+	private:
+		/** Every node but the root holds at least this many keys. */
+		static constexpr size_t MIN_KEYS = FANOUT / 2 - 1;
+
+		/**
+		 *	The packed bytes of the keys come first, so that a search reads them
+		 *	from the first cache lines of the node. They have their sign bit
+		 *	flipped, which lets signed vector compares order them like bytes.
+		 */
+		struct Node {
+			uint32_t count;
+
+			/** Length of the prefix that all keys of the node share. */
+			uint32_t shared;
+
+			bool leaf;
+
+			int64_t prefixes[FANOUT];
+			KeyType keys[FANOUT];
+		};
+
+		struct Leaf : Node {
+			ValueType values[FANOUT];
+			Leaf *next;
+		};
+
+		/** The keys of an inner node separate its children: `children[i + 1]` holds the keys not less than `keys[i]`. */
+		struct Inner : Node {
+			Node *children[FANOUT + 1];
+		};
+
+		/** The upper half of a node that was split, and the key that its parent routes by. */
+		struct Split {
+			KeyType separator;
+			Node *right;
+		};
+
+		Node *root;
+		size_t length;
+		size_t height;
+
+		static int64_t prefixOf(std::string_view bytes);
+		static size_t rankOf(const Node &node, std::string_view key, bool upper);
+		const Leaf & leafOf(std::string_view key) const;
+
+		static void repack(Node &node);
+		static void insertKey(Node &node, size_t pos, KeyType &&key);
+		static void eraseKey(Node &node, size_t pos);
+		static void replaceKey(Node &node, size_t pos, const KeyType &key);
+
+		static Leaf * createLeaf();
+		static Inner * createInner();
+
+		void rebalanceChild(Inner &parent, size_t i);
+		void borrowFromLeft(Inner &parent, size_t i);
+		void borrowFromRight(Inner &parent, size_t i);
+		void merge(Inner &parent, size_t i);
+
+		/* Recursive helper methods. */
+
+		bool insert(Node &node, std::string_view key, ValueType value, std::optional<Split> &split);
+		bool remove(Node &node, std::string_view key);
+		static Node * copyNode(const Node &node, Leaf *&previous);
+		static void destroyNode(Node *node);
+		static size_t memoryUsage(const Node &node);
+		static void printDepth(std::ostream &os, const Node &node, size_t depth);
+};
+
+/**
+ *	Calls `visit(key, value)` for every pair whose key lies in `[low, high]`,
+ *	in ascending order of the keys. After one descent to the first key, the
+ *	scan follows the links between the leaves.
+ *
+ *	Expected time complexity is `O(log(n) + k)` for `k` pairs in the range.
+ */
+template <typename Visitor>
+void BPlusTree::visitRange(std::string_view low, std::string_view high, Visitor &&visit) const {
+	if (high < low) {
+		return;
+	}
+
+	const Leaf *leaf = &this->leafOf(low);
+	for (size_t i = BPlusTree::rankOf(*leaf, low, false); leaf; leaf = leaf->next, i = 0) {
+		for (; i < leaf->count; ++i) {
+			if (high < leaf->keys[i]) {
+				return;
+			}
+			visit(leaf->keys[i], leaf->values[i]);
+		}
+	}
+}
+
+#endif // BPLUSTREE_H
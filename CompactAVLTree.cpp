@@ -0,0 +1,483 @@
+/**
+ *	CompactAVLTree.cpp
+ */
+
+#include "CompactAVLTree.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+
+CompactAVLTree::CompactAVLTree() :
+	root(NIL), freeList(NIL), length(0), deadKeyBytes(0) {}
+
+/**
+ *	Packs the first `PREFIX_BYTES` bytes of the `key` into an integer, with the
+ *	first byte as the most significant one. Shorter keys are padded with zeros.
+ *	Comparing two packed prefixes then orders them like comparing the bytes.
+ */
+uint64_t CompactAVLTree::prefixOf(std::string_view key) {
+	unsigned char bytes[PREFIX_BYTES] = {};
+	std::memcpy(bytes, key.data(), std::min(key.size(), PREFIX_BYTES));
+
+	uint64_t prefix = 0;
+	for (unsigned char byte : bytes) {
+		prefix = (prefix << 8) | byte;
+	}
+	return prefix;
+}
+
+CompactAVLTree::Probe::Probe(std::string_view key) :
+	key(key), prefix(CompactAVLTree::prefixOf(key)) {}
+
+/**
+ *	Three-way comparison of a search key with the key of a node.
+ *	Most comparisons are decided by the prefixes, which are inside the node.
+ *	Only if the prefixes are equal are the remaining bytes read from the key arena.
+ *
+ *	@return A negative integer if the search key is smaller; `0` if the keys are equal;
+ *	or a positive integer if the search key is greater.
+ */
+int CompactAVLTree::compare(const Probe &probe, const Node &node) const {
+	if (probe.prefix != node.prefix) {
+		return (probe.prefix < node.prefix) ? -1 : 1;
+	}
+
+	size_t shorter = std::min<size_t>(probe.key.size(), node.length);
+	if (shorter > PREFIX_BYTES) {
+		int cmp = std::memcmp(
+			probe.key.data() + PREFIX_BYTES, this->keyBytes.data() + node.suffix, shorter - PREFIX_BYTES
+		);
+		if (cmp != 0) {
+			return cmp;
+		}
+	}
+
+	if (probe.key.size() == node.length) {
+		return 0;
+	}
+	return (probe.key.size() < node.length) ? -1 : 1;
+}
+
+/** Rebuilds the key of a node from its prefix and the bytes in the key arena. */
+std::string CompactAVLTree::keyOf(const Node &node) const {
+	std::string key(node.length, '\0');
+	size_t inlineBytes = std::min<size_t>(node.length, PREFIX_BYTES);
+	for (size_t i = 0; i < inlineBytes; ++i) {
+		key[i] = static_cast<char>(node.prefix >> (8 * (PREFIX_BYTES - 1 - i)));
+	}
+	if (node.length > PREFIX_BYTES) {
+		std::memcpy(key.data() + PREFIX_BYTES, this->keyBytes.data() + node.suffix, node.length - PREFIX_BYTES);
+	}
+	return key;
+}
+
+/**
+ *	Inserts the key-value pair into the tree.
+ *	If the key already exists, its value is updated, and this returns `false`.
+ *	Keys of `MAX_KEY_LENGTH` bytes or more can't be stored, and are not inserted.
+ *	Neither is a key that would need a node index past `NIL - 1`, or key bytes
+ *	past the first 4 GiB of the key arena once the bytes of removed keys are
+ *	dropped, since nodes refer to both with 32-bit offsets.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+bool CompactAVLTree::insert(std::string_view key, ValueType value) {
+	if (key.size() >= MAX_KEY_LENGTH) {
+		return false;
+	}
+
+	Probe probe(key);
+	Path path;
+	uint32_t current = this->root;
+	bool goLeft = false;
+	while (current != NIL) {
+		Node &node = this->nodes[current];
+		int cmp = this->compare(probe, node);
+		if (cmp == 0) {
+			node.value = value;
+			return false;
+		}
+		path.nodes[path.depth++] = current;
+		goLeft = (cmp < 0);
+		current = goLeft ? node.left : node.right;
+	}
+
+	if (!this->hasRoomFor(key)) {
+		return false;
+	}
+
+	/**	Creating a node may move the vector of nodes, so the parent is linked
+	 *	only afterwards, through a fresh reference. */
+	uint32_t index = this->createNode(key, value);
+	if (path.depth == 0) {
+		this->root = index;
+	} else {
+		Node &parent = this->nodes[path.nodes[path.depth - 1]];
+		(goLeft ? parent.left : parent.right) = index;
+	}
+
+	++this->length;
+	this->retrace(path);
+	return true;
+}
+
+/**
+ *	If `key` exists in the tree, that key-value pair is removed, and this
+ *	returns `true`. Otherwise, the tree is not modified.
+ *
+ *	A node with two children is replaced by its successor, which is detached
+ *	on the same descent.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+bool CompactAVLTree::remove(std::string_view key) {
+	Probe probe(key);
+	Path path;
+	uint32_t current = this->root;
+	while (current != NIL) {
+		int cmp = this->compare(probe, this->nodes[current]);
+		if (cmp == 0) {
+			break;
+		}
+		path.nodes[path.depth++] = current;
+		current = (cmp < 0) ? this->nodes[current].left : this->nodes[current].right;
+	}
+
+	if (current == NIL) {
+		return false;
+	}
+
+	path.nodes[path.depth] = current;
+	uint32_t &slot = this->slotOf(path, path.depth);
+	Node &doomed = this->nodes[current];
+
+	if (doomed.left == NIL || doomed.right == NIL) {
+		slot = (doomed.left != NIL) ? doomed.left : doomed.right;
+	} else {
+		size_t removedDepth = path.depth;
+		path.nodes[path.depth++] = current;
+
+		uint32_t *minSlot = &doomed.right;
+		while (this->nodes[*minSlot].left != NIL) {
+			path.nodes[path.depth++] = *minSlot;
+			minSlot = &this->nodes[*minSlot].left;
+		}
+
+		uint32_t successor = *minSlot;
+		*minSlot = this->nodes[successor].right;
+		this->nodes[successor].left = doomed.left;
+		this->nodes[successor].right = doomed.right;
+		this->nodes[successor].height = doomed.height;
+		slot = successor;
+		path.nodes[removedDepth] = successor;
+	}
+
+	this->freeNode(current);
+	--this->length;
+	this->retrace(path);
+
+	/**	The key bytes of removed nodes are reclaimed once they make up most of
+	 *	the arena, so the cost of copying the live keys is amortized. */
+	if (this->deadKeyBytes > 4096 && 2 * this->deadKeyBytes > this->keyBytes.size()) {
+		this->compactKeys();
+	}
+	return true;
+}
+
+/**
+ *	Returns `true` if and only if the specified `key` is in the tree.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+bool CompactAVLTree::contains(std::string_view key) const {
+	return this->findNode(key) != NIL;
+}
+
+/**
+ *	Returns the value associated with the specified `key`, or nothing if the
+ *	key is not in the tree.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+std::optional<CompactAVLTree::ValueType> CompactAVLTree::get(std::string_view key) const {
+	uint32_t index = this->findNode(key);
+	if (index == NIL) {
+		return std::nullopt;
+	}
+	return this->nodes[index].value;
+}
+
+/** Descends from the root to the node holding `key`, or returns `NIL`. */
+uint32_t CompactAVLTree::findNode(std::string_view key) const {
+	Probe probe(key);
+	uint32_t current = this->root;
+	while (current != NIL) {
+		const Node &node = this->nodes[current];
+		int cmp = this->compare(probe, node);
+		if (cmp == 0) {
+			return current;
+		}
+		current = (cmp < 0) ? node.left : node.right;
+	}
+	return NIL;
+}
+
+/**
+ *	Returns a vector of every key in the tree, in ascending order.
+ *
+ *	Expected time complexity is `O(n)`.
+ */
+std::vector<CompactAVLTree::KeyType> CompactAVLTree::keys() const {
+	std::vector<KeyType> keyList;
+	keyList.reserve(this->length);
+	this->grabKey(keyList, this->root);
+	return keyList;
+}
+
+void CompactAVLTree::grabKey(std::vector<KeyType> &keyList, uint32_t current) const {
+	if (current != NIL) {
+		const Node &node = this->nodes[current];
+		this->grabKey(keyList, node.left);
+		keyList.push_back(this->keyOf(node));
+		this->grabKey(keyList, node.right);
+	}
+}
+
+/**
+ *	Returns the values of the keys in `[low, high]`, in ascending order of the
+ *	keys. Like `AVLTree::findRange`, a value that occurs more than once is
+ *	only returned the first time.
+ *
+ *	Expected time complexity is `O(log(n) + k)` for `k` pairs in the range.
+ */
+std::vector<CompactAVLTree::ValueType> CompactAVLTree::findRange(std::string_view low, std::string_view high) const {
+	std::vector<ValueType> valueList;
+	std::unordered_set<ValueType> seen;
+	this->visitRange(low, high, [&](const KeyType &, ValueType value) {
+		if (seen.insert(value).second) {valueList.push_back(value);}
+	});
+	return valueList;
+}
+
+/**
+ *	Returns the number of key-value pairs in the tree.
+ *
+ *	Expected time complexity is `O(1)`.
+ */
+size_t CompactAVLTree::size() const {return this->length;}
+
+/**
+ *	Returns the number of edges from the root to its deepest leaf, like
+ *	`AVLTree::getHeight`, or `-1` cast to `size_t` if the tree is empty.
+ *
+ *	Expected time complexity is `O(1)`.
+ */
+size_t CompactAVLTree::getHeight() const {
+	return this->heightOf(this->root) - size_t{1};
+}
+
+/**
+ *	Reserves room for `nodeCount` nodes and `keyBytes` bytes of keys, so that
+ *	loading a known number of keys doesn't move the vectors repeatedly.
+ */
+void CompactAVLTree::reserve(size_t nodeCount, size_t keyBytes) {
+	this->nodes.reserve(nodeCount);
+	this->keyBytes.reserve(keyBytes);
+}
+
+/** Removes every key-value pair, keeping the memory that was reserved. */
+void CompactAVLTree::clear() {
+	this->nodes.clear();
+	this->keyBytes.clear();
+	this->root = NIL;
+	this->freeList = NIL;
+	this->length = 0;
+	this->deadKeyBytes = 0;
+}
+
+/** Returns the number of bytes held by the tree, including reserved capacity. */
+size_t CompactAVLTree::memoryUsage() const {
+	return sizeof(*this) + this->nodes.capacity() * sizeof(Node) + this->keyBytes.capacity();
+}
+
+/**
+ *	Checks that one more node can be indexed, and that the bytes of `key` past
+ *	its prefix end within the 32-bit offsets of the key arena. If they don't,
+ *	the bytes of removed keys are dropped from the arena first, when there are any.
+ */
+bool CompactAVLTree::hasRoomFor(std::string_view key) {
+	if (this->freeList == NIL && this->nodes.size() >= NIL) {
+		return false;
+	}
+
+	size_t suffixBytes = (key.size() > PREFIX_BYTES) ? key.size() - PREFIX_BYTES : 0;
+	if (this->keyBytes.size() + suffixBytes > UINT32_MAX && this->deadKeyBytes > 0) {
+		this->compactKeys();
+	}
+	return this->keyBytes.size() + suffixBytes <= UINT32_MAX;
+}
+
+/**
+ *	Takes a node from the free list, or appends one to the vector of nodes.
+ *	The bytes of the key past its prefix are appended to the key arena.
+ */
+uint32_t CompactAVLTree::createNode(std::string_view key, ValueType value) {
+	uint32_t index;
+	if (this->freeList != NIL) {
+		index = this->freeList;
+		this->freeList = this->nodes[index].left;
+	} else {
+		index = static_cast<uint32_t>(this->nodes.size());
+		this->nodes.emplace_back();
+	}
+
+	Node &node = this->nodes[index];
+	node.prefix = CompactAVLTree::prefixOf(key);
+	node.value = value;
+	node.left = NIL;
+	node.right = NIL;
+	node.suffix = static_cast<uint32_t>(this->keyBytes.size());
+	node.length = static_cast<uint32_t>(key.size());
+	node.height = 1;
+
+	if (key.size() > PREFIX_BYTES) {
+		this->keyBytes.insert(this->keyBytes.end(), key.begin() + PREFIX_BYTES, key.end());
+	}
+	return index;
+}
+
+/** Pushes a node onto the free list, which is linked through the left child indices. */
+void CompactAVLTree::freeNode(uint32_t index) {
+	Node &node = this->nodes[index];
+	if (node.length > PREFIX_BYTES) {
+		this->deadKeyBytes += node.length - PREFIX_BYTES;
+	}
+	node.left = this->freeList;
+	this->freeList = index;
+}
+
+/** Copies the key bytes of every node in the tree into a new arena, leaving out removed keys. */
+void CompactAVLTree::compactKeys() {
+	std::vector<char> arena;
+	arena.reserve(this->keyBytes.size() - this->deadKeyBytes);
+	this->copyKeys(arena, this->root);
+	this->keyBytes = std::move(arena);
+	this->deadKeyBytes = 0;
+}
+
+void CompactAVLTree::copyKeys(std::vector<char> &arena, uint32_t current) {
+	if (current != NIL) {
+		Node &node = this->nodes[current];
+		if (node.length > PREFIX_BYTES) {
+			const char *bytes = this->keyBytes.data() + node.suffix;
+			node.suffix = static_cast<uint32_t>(arena.size());
+			arena.insert(arena.end(), bytes, bytes + (node.length - PREFIX_BYTES));
+		}
+		this->copyKeys(arena, node.left);
+		this->copyKeys(arena, node.right);
+	}
+}
+
+/**
+ *	Returns the index that links the node at position `i` of the path to its
+ *	parent, or the root index for the first node.
+ */
+uint32_t & CompactAVLTree::slotOf(const Path &path, size_t i) {
+	if (i == 0) {
+		return this->root;
+	}
+	Node &parent = this->nodes[path.nodes[i - 1]];
+	return (parent.left == path.nodes[i]) ? parent.left : parent.right;
+}
+
+/**
+ *	Walks back up the `path` after a node was linked below or unlinked from its
+ *	last node, rebalancing each node until a subtree keeps its height.
+ */
+void CompactAVLTree::retrace(const Path &path) {
+	for (size_t i = path.depth; i > 0; --i) {
+		uint32_t &slot = this->slotOf(path, i - 1);
+		uint32_t oldHeight = this->nodes[slot].height;
+		this->rebalance(slot);
+		if (this->nodes[slot].height == oldHeight) {
+			break;
+		}
+	}
+}
+
+/**
+ *	Recalculates the height of the node at `slot`, and rotates it if its
+ *	children's heights differ by more than 1. A child leaning the other way
+ *	is rotated first, which makes a double rotation.
+ */
+void CompactAVLTree::rebalance(uint32_t &slot) {
+	this->update(slot);
+
+	ssize_t balance = this->balanceOf(slot);
+	if (balance > 1) {
+		if (this->balanceOf(this->nodes[slot].left) < 0) {
+			this->rotateLeft(this->nodes[slot].left);
+		}
+		this->rotateRight(slot);
+	} else if (balance < -1) {
+		if (this->balanceOf(this->nodes[slot].right) > 0) {
+			this->rotateRight(this->nodes[slot].right);
+		}
+		this->rotateLeft(slot);
+	}
+}
+
+/** Rotate the node held by this index to the left. */
+void CompactAVLTree::rotateLeft(uint32_t &slot) {
+	uint32_t top = slot;
+	uint32_t pivot = this->nodes[top].right;
+	this->nodes[top].right = this->nodes[pivot].left;
+	this->nodes[pivot].left = top;
+	this->update(top);
+	this->update(pivot);
+	slot = pivot;
+}
+
+/** Rotate the node held by this index to the right. */
+void CompactAVLTree::rotateRight(uint32_t &slot) {
+	uint32_t top = slot;
+	uint32_t pivot = this->nodes[top].left;
+	this->nodes[top].left = this->nodes[pivot].right;
+	this->nodes[pivot].right = top;
+	this->update(top);
+	this->update(pivot);
+	slot = pivot;
+}
+
+uint32_t CompactAVLTree::heightOf(uint32_t index) const {
+	return (index == NIL) ? 0 : this->nodes[index].height;
+}
+
+/** The difference between the heights of the node's children. */
+ssize_t CompactAVLTree::balanceOf(uint32_t index) const {
+	const Node &node = this->nodes[index];
+	return static_cast<ssize_t>(this->heightOf(node.left)) - static_cast<ssize_t>(this->heightOf(node.right));
+}
+
+void CompactAVLTree::update(uint32_t index) {
+	Node &node = this->nodes[index];
+	node.height = std::max(this->heightOf(node.left), this->heightOf(node.right)) + 1;
+}
+
+/**
+ *	Prints every node in the tree that resembles the tree's structure,
+ *	in the same format as `AVLTree`.
+ */
+std::ostream & operator<<(std::ostream &os, const CompactAVLTree &tree) {
+	tree.printDepth(os, tree.root, 0);
+	return os;
+}
+
+void CompactAVLTree::printDepth(std::ostream &os, uint32_t current, size_t depth) const {
+	if (current != NIL) {
+		const Node &node = this->nodes[current];
+		this->printDepth(os, node.right, depth + 1);
+		os << std::string(2 * depth, ' ') << "{" << this->keyOf(node) << ": " << node.value << "}\n";
+		this->printDepth(os, node.left, depth + 1);
+	}
+}
@@ -0,0 +1,171 @@
+/**
+ *	CompactAVLTree.h
+ */
+
+#ifndef COMPACTAVLTREE_H
+#define COMPACTAVLTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ *	An AVL tree of `std::string` keys and `size_t` values, stored for memory
+ *	density instead of pointer chasing.
+ *
+ *	All nodes live in one contiguous vector and link to each other with 32-bit
+ *	indices. Each node holds the first `PREFIX_BYTES` bytes of its key inline,
+ *	packed so that comparing two prefixes is a single integer comparison. Only
+ *	the bytes after the prefix are kept in a separate key arena, and they are
+ *	read only if the prefixes of two keys are equal.
+ *
+ *	A node takes 32 bytes, so two nodes share a cache line. The tree holds at
+ *	most `2^32 - 1` nodes, keys of less than `MAX_KEY_LENGTH` bytes, and up to
+ *	4 GiB of key bytes past the prefixes. `insert()` rejects a key that would
+ *	go past any of these limits.
+ */
+class CompactAVLTree {
+	public:
+		using KeyType = std::string;
+		using ValueType = size_t;
+
+		static constexpr size_t PREFIX_BYTES = 8;
+		static constexpr size_t MAX_KEY_LENGTH = size_t{1} << 24;
+
+		CompactAVLTree();
+
+		bool insert(std::string_view key, ValueType value);
+		bool remove(std::string_view key);
+		bool contains(std::string_view key) const;
+		std::optional<ValueType> get(std::string_view key) const;
+
+		std::vector<KeyType> keys() const;
+		std::vector<ValueType> findRange(std::string_view low, std::string_view high) const;
+
+		template <typename Visitor>
+		void visitRange(std::string_view low, std::string_view high, Visitor &&visit) const;
+
+		size_t size() const;
+		size_t getHeight() const;
+
+		void reserve(size_t nodeCount, size_t keyBytes = 0);
+		void clear();
+		size_t memoryUsage() const;
+
+		friend std::ostream & operator<<(std::ostream &os, const CompactAVLTree &tree);
+
+	private:
+		static constexpr uint32_t NIL = UINT32_MAX;
+
+		/** Heights are counted in nodes, so a leaf has height `1` and an empty subtree `0`. */
+		struct Node {
+
+			/** The first bytes of the key, big-endian and zero padded. */
+			uint64_t prefix;
+
+			ValueType value;
+			uint32_t left;
+			uint32_t right;
+
+			/** Offset of the bytes after the prefix in the key arena. */
+			uint32_t suffix;
+
+			uint32_t length : 24;
+			uint32_t height : 8;
+		};
+
+		static_assert(sizeof(Node) == 32);
+
+		/** Search key with its prefix computed once for the whole descent. */
+		struct Probe {
+			std::string_view key;
+			uint64_t prefix;
+
+			explicit Probe(std::string_view key);
+		};
+
+		std::vector<Node> nodes;
+		std::vector<char> keyBytes;
+		uint32_t root;
+		uint32_t freeList;
+		size_t length;
+
+		/** Number of bytes in the key arena that belong to removed keys. */
+		size_t deadKeyBytes;
+
+		/** The nodes on the way from the root down to one node. */
+		struct Path {
+			static constexpr size_t MAX_DEPTH = 64;
+
+			uint32_t nodes[MAX_DEPTH];
+			size_t depth = 0;
+		};
+
+		static uint64_t prefixOf(std::string_view key);
+		int compare(const Probe &probe, const Node &node) const;
+		std::string keyOf(const Node &node) const;
+
+		uint32_t findNode(std::string_view key) const;
+		bool hasRoomFor(std::string_view key);
+		uint32_t createNode(std::string_view key, ValueType value);
+		void freeNode(uint32_t index);
+		void compactKeys();
+
+		uint32_t & slotOf(const Path &path, size_t i);
+		void retrace(const Path &path);
+		void rebalance(uint32_t &slot);
+		void rotateLeft(uint32_t &slot);
+		void rotateRight(uint32_t &slot);
+
+		uint32_t heightOf(uint32_t index) const;
+		ssize_t balanceOf(uint32_t index) const;
+		void update(uint32_t index);
+
+		/* Recursive helper methods. */
+
+		void grabKey(std::vector<KeyType> &keyList, uint32_t current) const;
+		void copyKeys(std::vector<char> &arena, uint32_t current);
+		void printDepth(std::ostream &os, uint32_t current, size_t depth) const;
+
+		template <typename Visitor>
+		void visitRange(uint32_t current, const Probe &low, const Probe &high, Visitor &visit) const;
+};
+
+/**
+ *	Calls `visit(key, value)` for every pair whose key lies in `[low, high]`,
+ *	in ascending order of the keys. Subtrees entirely outside of the range are
+ *	not entered.
+ *
+ *	Expected time complexity is `O(log(n) + k)` for `k` pairs in the range.
+ */
+template <typename Visitor>
+void CompactAVLTree::visitRange(std::string_view low, std::string_view high, Visitor &&visit) const {
+	this->visitRange(this->root, Probe(low), Probe(high), visit);
+}
+
+template <typename Visitor>
+void CompactAVLTree::visitRange(uint32_t current, const Probe &low, const Probe &high, Visitor &visit) const {
+	if (current == NIL) {
+		return;
+	}
+
+	const Node &node = this->nodes[current];
+	bool aboveLow = this->compare(low, node) <= 0;
+	bool belowHigh = this->compare(high, node) >= 0;
+
+	if (aboveLow) {
+		this->visitRange(node.left, low, high, visit);
+	}
+	if (aboveLow && belowHigh) {
+		visit(this->keyOf(node), node.value);
+	}
+	if (belowHigh) {
+		this->visitRange(node.right, low, high, visit);
+	}
+}
+
+#endif // COMPACTAVLTREE_H
@@ -0,0 +1,11 @@
+/**
+ *	ConcurrentAVLTree.cpp
+ *
+ *	The method definitions of `BasicConcurrentAVLTree` live in
+ *	`ConcurrentAVLTree.tpp`. The default tree, `ConcurrentAVLTree`, is
+ *	instantiated once here.
+ */
+
+#include "ConcurrentAVLTree.h"
+
+template class BasicConcurrentAVLTree<>;
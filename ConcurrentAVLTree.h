@@ -0,0 +1,119 @@
+/**
+ *	ConcurrentAVLTree.h
+ */
+
+#ifndef CONCURRENTAVLTREE_H
+#define CONCURRENTAVLTREE_H
+
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <vector>
+#include "AVLTree.h"
+
+/**
+ *	A `BasicAVLTree` that can be shared between threads.
+ *
+ *	Readers hold a shared lock, so any number of `get`, `contains`, `findRange`
+ *	and iterations run at the same time. Writers hold the exclusive lock.
+ *
+ *	Insertions and removals can also be queued. Queued writes are not visible to
+ *	readers until they are applied by `flush()`, which takes the exclusive lock
+ *	once for the whole batch. The queue has its own mutex, so queueing a write
+ *	never waits for the readers.
+ */
+template <
+	typename Key = std::string, typename Value = size_t,
+	typename Compare = std::less<>, typename Allocator = std::allocator<std::pair<const Key, Value>>
+>
+class BasicConcurrentAVLTree {
+	public:
+		using Tree = BasicAVLTree<Key, Value, Compare, Allocator>;
+		using KeyType = typename Tree::KeyType;
+		using ValueType = typename Tree::ValueType;
+		using Bound = typename Tree::Bound;
+
+		/** The queue is flushed by the write that fills it, unless `batchLimit` is `0`. */
+		static constexpr size_t DEFAULT_BATCH_LIMIT = 1024;
+
+		/**
+		 *	Shared access to the tree for as long as this view lives, so that the
+		 *	tree can be iterated or queried several times while no writer runs.
+		 */
+		class ReadView {
+			public:
+				const Tree & operator*() const {return *this->tree;}
+				const Tree * operator->() const {return this->tree;}
+
+				typename Tree::const_iterator begin() const {return this->tree->begin();}
+				typename Tree::const_iterator end() const {return this->tree->end();}
+
+			private:
+				friend class BasicConcurrentAVLTree;
+
+				std::shared_lock<std::shared_mutex> lock;
+				const Tree *tree;
+
+				ReadView(std::shared_mutex &mutex, const Tree &tree) : lock(mutex), tree(&tree) {}
+		};
+
+		explicit BasicConcurrentAVLTree(size_t batchLimit = DEFAULT_BATCH_LIMIT);
+
+		BasicConcurrentAVLTree(const BasicConcurrentAVLTree &) = delete;
+		BasicConcurrentAVLTree & operator=(const BasicConcurrentAVLTree &) = delete;
+
+		bool insert(const KeyType &key, ValueType value);
+		bool remove(const KeyType &key);
+
+		void queueInsert(KeyType key, ValueType value);
+		void queueRemove(KeyType key);
+		size_t flush();
+		size_t pending() const;
+
+		bool contains(const KeyType &key) const;
+		std::optional<ValueType> get(const KeyType &key) const;
+		std::vector<ValueType> findRange(const KeyType &low, const KeyType &high) const;
+
+		template <typename Visitor>
+		void visitRange(
+			const KeyType &low, const KeyType &high, Visitor &&visit,
+			Bound lowBound = Bound::INCLUSIVE, Bound highBound = Bound::INCLUSIVE
+		) const;
+
+		size_t size() const;
+
+		ReadView read() const;
+
+		template <typename Fn>
+		decltype(auto) write(Fn &&fn);
+
+	private:
+
+		/** An insertion, or a removal if `value` is empty. */
+		struct PendingWrite {
+			KeyType key;
+			std::optional<ValueType> value;
+		};
+
+		mutable std::shared_mutex treeMutex;
+		Tree tree;
+
+		mutable std::mutex queueMutex;
+		std::vector<PendingWrite> queue;
+		size_t batchLimit;
+
+		/** Held by one flush at a time, so that batches are applied in the order they were queued. */
+		std::mutex flushMutex;
+
+		void enqueue(PendingWrite &&write);
+};
+
+#include "ConcurrentAVLTree.tpp"
+
+/** The concurrent tree of `std::string` keys and `size_t` values, which is instantiated once in `ConcurrentAVLTree.cpp`. */
+using ConcurrentAVLTree = BasicConcurrentAVLTree<>;
+
+extern template class BasicConcurrentAVLTree<>;
+
+#endif // CONCURRENTAVLTREE_H
@@ -0,0 +1,161 @@
+/**
+ *	ConcurrentAVLTree.tpp
+ *
+ *	Contains all method definitions of the class template declared in
+ *	`ConcurrentAVLTree.h`, which includes this file.
+ */
+
+#include <algorithm>
+#include <utility>
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::BasicConcurrentAVLTree(size_t batchLimit) :
+	batchLimit(batchLimit) {}
+
+/**
+ *	Inserts the key-value pair right away, under the exclusive lock.
+ *	Same as `AVLTree::insert`, an existing key has its value updated.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::insert(const KeyType &key, ValueType value) {
+	std::unique_lock lock(this->treeMutex);
+	return this->tree.insert(key, std::move(value));
+}
+
+/** Removes the key right away, under the exclusive lock. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::remove(const KeyType &key) {
+	std::unique_lock lock(this->treeMutex);
+	return this->tree.remove(key);
+}
+
+/**
+ *	Queues an insertion, which is applied by the next `flush()`.
+ *	Writes queued by one thread are applied in the order they were queued.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::queueInsert(KeyType key, ValueType value) {
+	this->enqueue(PendingWrite{std::move(key), std::move(value)});
+}
+
+/** Queues a removal, which is applied by the next `flush()`. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::queueRemove(KeyType key) {
+	this->enqueue(PendingWrite{std::move(key), std::nullopt});
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+void BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::enqueue(PendingWrite &&write) {
+	bool full;
+	{
+		std::lock_guard lock(this->queueMutex);
+		this->queue.push_back(std::move(write));
+		full = (this->batchLimit != 0) && (this->queue.size() >= this->batchLimit);
+	}
+	if (full) {
+		this->flush();
+	}
+}
+
+/**
+ *	Applies every queued write under a single exclusive section.
+ *
+ *	The batch is taken off the queue and sorted by key before the exclusive
+ *	lock is taken, so readers are only held back while the writes are applied,
+ *	and consecutive writes descend through the same nodes. The sort is stable,
+ *	so writes to the same key keep their order.
+ *
+ *	@return The number of writes that were applied.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::flush() {
+	std::lock_guard flushLock(this->flushMutex);
+
+	std::vector<PendingWrite> batch;
+	{
+		std::lock_guard lock(this->queueMutex);
+		batch.swap(this->queue);
+	}
+	if (batch.empty()) {
+		return 0;
+	}
+
+	Compare comp = this->tree.key_comp();
+	std::stable_sort(batch.begin(), batch.end(), [&comp](const PendingWrite &a, const PendingWrite &b) {
+		return comp(a.key, b.key);
+	});
+
+	std::unique_lock lock(this->treeMutex);
+	for (PendingWrite &write : batch) {
+		if (write.value) {
+			this->tree.insert(std::move(write.key), std::move(*write.value));
+		} else {
+			this->tree.remove(write.key);
+		}
+	}
+	return batch.size();
+}
+
+/** Returns the number of writes waiting for the next `flush()`. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::pending() const {
+	std::lock_guard lock(this->queueMutex);
+	return this->queue.size();
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::contains(const KeyType &key) const {
+	std::shared_lock lock(this->treeMutex);
+	return this->tree.contains(key);
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+std::optional<typename BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::ValueType> BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::get(const KeyType &key) const {
+	std::shared_lock lock(this->treeMutex);
+	return this->tree.get(key);
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+std::vector<typename BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::ValueType> BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::findRange(const KeyType &low, const KeyType &high) const {
+	std::shared_lock lock(this->treeMutex);
+	return this->tree.findRange(low, high);
+}
+
+/**
+ *	Same as `AVLTree::visitRange`, while holding the shared lock.
+ *	The visitor must not write to this tree, since that would deadlock.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename Visitor>
+void BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::visitRange(
+	const KeyType &low, const KeyType &high, Visitor &&visit, Bound lowBound, Bound highBound
+) const {
+	std::shared_lock lock(this->treeMutex);
+	this->tree.visitRange(low, high, std::forward<Visitor>(visit), lowBound, highBound);
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::size() const {
+	std::shared_lock lock(this->treeMutex);
+	return this->tree.size();
+}
+
+/**
+ *	Returns a view holding the shared lock, through which the tree can be
+ *	iterated. Writers wait until every view is destroyed.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::ReadView BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::read() const {
+	return ReadView(this->treeMutex, this->tree);
+}
+
+/**
+ *	Calls `fn` with the tree under the exclusive lock, for compound updates
+ *	that must not be seen halfway by readers.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename Fn>
+decltype(auto) BasicConcurrentAVLTree<Key, Value, Compare, Allocator>::write(Fn &&fn) {
+	std::unique_lock lock(this->treeMutex);
+	return std::forward<Fn>(fn)(this->tree);
+}
@@ -0,0 +1,10 @@
+/**
+ *	FrozenAVLTree.cpp
+ *
+ *	The method definitions of `BasicFrozenAVLTree` live in `FrozenAVLTree.tpp`.
+ *	The default frozen tree, `FrozenAVLTree`, is instantiated once here.
+ */
+
+#include "FrozenAVLTree.h"
+
+template class BasicFrozenAVLTree<>;
@@ -0,0 +1,119 @@
+/**
+ *	FrozenAVLTree.h
+ */
+
+#ifndef FROZENAVLTREE_H
+#define FROZENAVLTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "AVLTree.h"
+
+/**
+ *	An immutable copy of a `BasicAVLTree`, made by `BasicAVLTree::freeze()` and
+ *	laid out for lookups instead of updates.
+ *
+ *	The entries are kept in one array in ascending order, so range scans read
+ *	memory sequentially. Lookups descend a second array, which holds the same
+ *	keys in Eytzinger order: the implicit binary search tree whose root is at
+ *	slot `1` and whose slot `i` has the children `2 * i` and `2 * i + 1`. The
+ *	top levels share a few cache lines, and the slots four levels below the
+ *	current one are contiguous, so they are prefetched while the descent goes on.
+ *
+ *	For `std::string` keys in byte order, each slot holds 8 key bytes packed
+ *	into an integer, so that most steps of a descent are one integer comparison,
+ *	and the next slot is picked without a branch on its result. The bytes are
+ *	taken after the longest prefix that all keys share, since those bytes
+ *	can't tell any two keys apart. Only if the packed bytes are equal are the
+ *	keys themselves compared.
+ */
+template <typename Key = std::string, typename Value = size_t, typename Compare = std::less<>>
+class BasicFrozenAVLTree {
+	public:
+		using KeyType = Key;
+		using ValueType = Value;
+
+		/** A key-value pair, as seen through the iterators. */
+		struct Entry {
+			KeyType key;
+			ValueType value;
+		};
+
+		using const_iterator = typename std::vector<Entry>::const_iterator;
+
+		explicit BasicFrozenAVLTree(const Compare &comp = Compare());
+
+		bool contains(const KeyType &key) const;
+		template <typename K> requires TransparentCompare<Compare>
+		bool contains(const K &key) const;
+
+		std::optional<ValueType> get(const KeyType &key) const;
+		template <typename K> requires TransparentCompare<Compare>
+		std::optional<ValueType> get(const K &key) const;
+
+		const_iterator lower_bound(const KeyType &key) const;
+		template <typename K> requires TransparentCompare<Compare>
+		const_iterator lower_bound(const K &key) const;
+
+		const_iterator upper_bound(const KeyType &key) const;
+		template <typename K> requires TransparentCompare<Compare>
+		const_iterator upper_bound(const K &key) const;
+
+		const_iterator begin() const;
+		const_iterator end() const;
+
+		std::vector<ValueType> findRange(const KeyType &low, const KeyType &high) const;
+
+		template <typename Visitor>
+		void visitRange(const KeyType &low, const KeyType &high, Visitor &&visit) const;
+
+		size_t size() const;
+
+	private:
+		template <typename, typename, typename, typename>
+		friend class BasicAVLTree;
+
+		static constexpr bool USES_STRING_ORDER = std::is_same_v<Key, std::string> && (
+			std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<std::string>>
+		);
+
+		static constexpr size_t PREFIX_BYTES = 8;
+
+		/** The entries in ascending order of their keys. */
+		std::vector<Entry> entries;
+
+		/** The position in `entries` of the key at each slot of the Eytzinger order. Slot `0` is unused. */
+		std::vector<size_t> ranks;
+
+		/** For string keys, the packed bytes after `commonPrefix` of the key at each slot. */
+		std::vector<uint64_t> prefixes;
+		std::string commonPrefix;
+
+		[[no_unique_address]] Compare comp;
+
+		BasicFrozenAVLTree(std::vector<Entry> &&entries, const Compare &comp);
+
+		void layOut(size_t &rank, size_t slot);
+
+		static uint64_t packPrefix(std::string_view bytes);
+
+		template <typename K>
+		size_t boundOf(const K &key, bool upper) const;
+		template <typename K>
+		bool isKeyAt(size_t rank, const K &key) const;
+};
+
+#include "FrozenAVLTree.tpp"
+
+/** The frozen tree of `std::string` keys and `size_t` values, which is instantiated once in `FrozenAVLTree.cpp`. */
+using FrozenAVLTree = BasicFrozenAVLTree<>;
+
+extern template class BasicFrozenAVLTree<>;
+
+#endif // FROZENAVLTREE_H
@@ -0,0 +1,273 @@
+/**
+ *	FrozenAVLTree.tpp
+ *
+ *	Contains all method definitions of the class template declared in
+ *	`FrozenAVLTree.h`, which includes this file.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <unordered_set>
+#include <utility>
+
+template <typename Key, typename Value, typename Compare>
+BasicFrozenAVLTree<Key, Value, Compare>::BasicFrozenAVLTree(const Compare &comp) :
+	ranks(1), comp(comp) {}
+
+/**
+ *	Lays out `entries`, whose keys must be unique and in ascending order.
+ *
+ *	Expected time complexity is `O(n)`.
+ */
+template <typename Key, typename Value, typename Compare>
+BasicFrozenAVLTree<Key, Value, Compare>::BasicFrozenAVLTree(std::vector<Entry> &&entries, const Compare &comp) :
+	entries(std::move(entries)), ranks(this->entries.size() + 1), comp(comp) {
+	if constexpr (USES_STRING_ORDER) {
+		if (!this->entries.empty()) {
+			std::string_view first = this->entries.front().key;
+			std::string_view last = this->entries.back().key;
+			size_t shared = std::mismatch(first.begin(), first.end(), last.begin(), last.end()).first - first.begin();
+			this->commonPrefix = first.substr(0, shared);
+		}
+		this->prefixes.resize(this->entries.size() + 1);
+	}
+
+	size_t rank = 0;
+	this->layOut(rank, 1);
+}
+
+/**
+ *	Recursive helper that fills the subtree of the Eytzinger order rooted at
+ *	`slot` with the next keys in ascending order. An in-order walk of the
+ *	implicit tree meets the slots in the order of the keys they must hold.
+ */
+template <typename Key, typename Value, typename Compare>
+void BasicFrozenAVLTree<Key, Value, Compare>::layOut(size_t &rank, size_t slot) {
+	if (slot >= this->ranks.size()) {
+		return;
+	}
+
+	this->layOut(rank, 2 * slot);
+	this->ranks[slot] = rank;
+	if constexpr (USES_STRING_ORDER) {
+		std::string_view key = this->entries[rank].key;
+		this->prefixes[slot] = BasicFrozenAVLTree::packPrefix(key.substr(this->commonPrefix.size()));
+	}
+	++rank;
+	this->layOut(rank, 2 * slot + 1);
+}
+
+/**
+ *	Packs the first `PREFIX_BYTES` bytes into an integer, with the first byte
+ *	as the most significant one. Shorter byte strings are padded with zeros.
+ */
+template <typename Key, typename Value, typename Compare>
+uint64_t BasicFrozenAVLTree<Key, Value, Compare>::packPrefix(std::string_view bytes) {
+	unsigned char packed[PREFIX_BYTES] = {};
+	std::memcpy(packed, bytes.data(), std::min(bytes.size(), PREFIX_BYTES));
+
+	uint64_t prefix = 0;
+	for (unsigned char byte : packed) {
+		prefix = (prefix << 8) | byte;
+	}
+	return prefix;
+}
+
+/**
+ *	Returns the position in `entries` of the first key that is not less than
+ *	`key`, or that is greater than `key` if `upper` is set.
+ *
+ *	The descent walks the Eytzinger order down to a leaf, going right past
+ *	every key that is on the lower side. The answer is then the last slot where
+ *	it went left, which is found by dropping the trailing right turns, and the
+ *	left turn before them, from the slot number.
+ */
+template <typename Key, typename Value, typename Compare>
+template <typename K>
+size_t BasicFrozenAVLTree<Key, Value, Compare>::boundOf(const K &key, bool upper) const {
+	const size_t n = this->entries.size();
+	size_t slot = 1;
+
+	if constexpr (USES_STRING_ORDER && std::is_convertible_v<const K &, std::string_view>) {
+		std::string_view view = key;
+		std::string_view common = this->commonPrefix;
+		size_t matched = std::mismatch(view.begin(), view.end(), common.begin(), common.end()).first - view.begin();
+		if (matched < common.size()) {
+			bool below = (matched == view.size()) ||
+				(static_cast<unsigned char>(view[matched]) < static_cast<unsigned char>(common[matched]));
+			return below ? 0 : n;
+		}
+
+		std::string_view rest = view.substr(common.size());
+		uint64_t probe = BasicFrozenAVLTree::packPrefix(rest);
+		const uint64_t *prefixes = this->prefixes.data();
+		while (slot <= n) {
+			__builtin_prefetch(prefixes + 16 * slot);
+			__builtin_prefetch(prefixes + 16 * slot + 8);
+
+			uint64_t prefix = prefixes[slot];
+			size_t right = upper ? (prefix <= probe) : (prefix < probe);
+			if (prefix == probe) [[unlikely]] {
+				int cmp = std::string_view(this->entries[this->ranks[slot]].key).substr(common.size()).compare(rest);
+				right = upper ? (cmp <= 0) : (cmp < 0);
+			}
+			slot = 2 * slot + right;
+		}
+	} else {
+		const size_t *ranks = this->ranks.data();
+		while (slot <= n) {
+			__builtin_prefetch(ranks + 16 * slot);
+
+			const KeyType &slotKey = this->entries[ranks[slot]].key;
+			size_t right = upper ? !this->comp(key, slotKey) : this->comp(slotKey, key);
+			slot = 2 * slot + right;
+		}
+	}
+
+	slot >>= std::countr_one(slot) + 1;
+	return (slot == 0) ? n : this->ranks[slot];
+}
+
+/** Checks whether the entry at `rank`, which is not less than `key`, holds `key`. */
+template <typename Key, typename Value, typename Compare>
+template <typename K>
+bool BasicFrozenAVLTree<Key, Value, Compare>::isKeyAt(size_t rank, const K &key) const {
+	return rank < this->entries.size() && !this->comp(key, this->entries[rank].key);
+}
+
+/**
+ *	Checks whether the tree holds the key.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare>
+bool BasicFrozenAVLTree<Key, Value, Compare>::contains(const KeyType &key) const {
+	return this->isKeyAt(this->boundOf(key, false), key);
+}
+
+/** Same as the other `contains()`, for any type that the transparent comparator accepts. */
+template <typename Key, typename Value, typename Compare>
+template <typename K> requires TransparentCompare<Compare>
+bool BasicFrozenAVLTree<Key, Value, Compare>::contains(const K &key) const {
+	return this->isKeyAt(this->boundOf(key, false), key);
+}
+
+/**
+ *	Gets the value of a key.
+ *
+ *	@return The value, or nothing if the tree doesn't hold the key.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare>
+std::optional<typename BasicFrozenAVLTree<Key, Value, Compare>::ValueType> BasicFrozenAVLTree<Key, Value, Compare>::get(const KeyType &key) const {
+	size_t rank = this->boundOf(key, false);
+	if (this->isKeyAt(rank, key)) {
+		return this->entries[rank].value;
+	}
+	return std::nullopt;
+}
+
+/** Same as the other `get()`, for any type that the transparent comparator accepts. */
+template <typename Key, typename Value, typename Compare>
+template <typename K> requires TransparentCompare<Compare>
+std::optional<typename BasicFrozenAVLTree<Key, Value, Compare>::ValueType> BasicFrozenAVLTree<Key, Value, Compare>::get(const K &key) const {
+	size_t rank = this->boundOf(key, false);
+	if (this->isKeyAt(rank, key)) {
+		return this->entries[rank].value;
+	}
+	return std::nullopt;
+}
+
+/**
+ *	Returns an iterator to the first entry whose key is not less than `key`,
+ *	or `end()` if there is none.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare>
+typename BasicFrozenAVLTree<Key, Value, Compare>::const_iterator BasicFrozenAVLTree<Key, Value, Compare>::lower_bound(const KeyType &key) const {
+	return this->entries.begin() + this->boundOf(key, false);
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename K> requires TransparentCompare<Compare>
+typename BasicFrozenAVLTree<Key, Value, Compare>::const_iterator BasicFrozenAVLTree<Key, Value, Compare>::lower_bound(const K &key) const {
+	return this->entries.begin() + this->boundOf(key, false);
+}
+
+/**
+ *	Returns an iterator to the first entry whose key is greater than `key`,
+ *	or `end()` if there is none.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare>
+typename BasicFrozenAVLTree<Key, Value, Compare>::const_iterator BasicFrozenAVLTree<Key, Value, Compare>::upper_bound(const KeyType &key) const {
+	return this->entries.begin() + this->boundOf(key, true);
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename K> requires TransparentCompare<Compare>
+typename BasicFrozenAVLTree<Key, Value, Compare>::const_iterator BasicFrozenAVLTree<Key, Value, Compare>::upper_bound(const K &key) const {
+	return this->entries.begin() + this->boundOf(key, true);
+}
+
+template <typename Key, typename Value, typename Compare>
+typename BasicFrozenAVLTree<Key, Value, Compare>::const_iterator BasicFrozenAVLTree<Key, Value, Compare>::begin() const {
+	return this->entries.begin();
+}
+
+template <typename Key, typename Value, typename Compare>
+typename BasicFrozenAVLTree<Key, Value, Compare>::const_iterator BasicFrozenAVLTree<Key, Value, Compare>::end() const {
+	return this->entries.end();
+}
+
+/**
+ *	Gets the values of all keys in `[low, high]`, in ascending order of the keys.
+ *	Like `AVLTree::findRange`, a value that occurs more than once is only
+ *	returned the first time, unless values have no `std::hash`.
+ *
+ *	Expected time complexity is `O(log(n) + m)`, where `m` is the number of keys in the range.
+ */
+template <typename Key, typename Value, typename Compare>
+std::vector<typename BasicFrozenAVLTree<Key, Value, Compare>::ValueType> BasicFrozenAVLTree<Key, Value, Compare>::findRange(const KeyType &low, const KeyType &high) const {
+	std::vector<ValueType> valueList;
+	if constexpr (requires (const ValueType &value) {std::hash<ValueType>{}(value);}) {
+		std::unordered_set<ValueType> seen;
+		this->visitRange(low, high, [&](const KeyType &, const ValueType &value) {
+			if (seen.insert(value).second) {valueList.push_back(value);}
+		});
+	} else {
+		this->visitRange(low, high, [&valueList](const KeyType &, const ValueType &value) {
+			valueList.push_back(value);
+		});
+	}
+	return valueList;
+}
+
+/**
+ *	Calls `visit(key, value)` for every key in `[low, high]`, in ascending
+ *	order. The entries of the range are contiguous, so after the two descents
+ *	this is a sequential scan.
+ *
+ *	Expected time complexity is `O(log(n) + m)`, where `m` is the number of keys in the range.
+ */
+template <typename Key, typename Value, typename Compare>
+template <typename Visitor>
+void BasicFrozenAVLTree<Key, Value, Compare>::visitRange(const KeyType &low, const KeyType &high, Visitor &&visit) const {
+	if (this->comp(high, low)) {
+		return;
+	}
+
+	size_t last = this->boundOf(high, true);
+	for (size_t i = this->boundOf(low, false); i < last; ++i) {
+		visit(this->entries[i].key, this->entries[i].value);
+	}
+}
+
+template <typename Key, typename Value, typename Compare>
+size_t BasicFrozenAVLTree<Key, Value, Compare>::size() const {
+	return this->entries.size();
+}
@@ -0,0 +1,166 @@
+/**
+ *	HashIndex.h
+ *
+ *	Open-addressing hash table from the keys of a tree to its nodes.
+ */
+
+#ifndef HASHINDEX_H
+#define HASHINDEX_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ *	A set of pointers to the items of another container, which can be looked up
+ *	by the hash of their keys. The table doesn't know the keys: it stores the
+ *	hash of each item next to the pointer, and a lookup compares the hashes
+ *	first and calls back with the item to compare the keys.
+ *
+ *	Items are placed by linear probing into a power of two number of slots,
+ *	which is doubled once three quarters of them are taken. Erasing an item
+ *	shifts the items after it back into its slot, so that no tombstones slow
+ *	down later lookups.
+ *
+ *	An index starts out disabled, with no slots at all, and only `reset()`
+ *	gives it slots. Lookups and updates may only be called on an enabled index.
+ */
+template <typename T, typename Allocator = std::allocator<T *>>
+class HashIndex {
+	public:
+		static constexpr size_t MIN_SLOTS = 16;
+
+		explicit HashIndex(const Allocator &alloc = Allocator()) :
+			slots(SlotAllocator(alloc)), count(0), shift(64) {}
+
+		HashIndex(HashIndex &&other) noexcept :
+			slots(std::move(other.slots)), count(std::exchange(other.count, 0)), shift(std::exchange(other.shift, 64)) {}
+
+		HashIndex & operator=(HashIndex &&other) noexcept {
+			if (this != &other) {
+				this->slots = std::move(other.slots);
+				this->count = std::exchange(other.count, 0);
+				this->shift = std::exchange(other.shift, 64);
+				other.slots.clear();
+			}
+			return *this;
+		}
+
+		bool isEnabled() const {return !this->slots.empty();}
+
+		/** Empties the index, and gives it room for `expected` items before it has to grow. */
+		void reset(size_t expected = 0) {
+			size_t slotCount = std::max(MIN_SLOTS, std::bit_ceil(expected + expected / 3 + 1));
+			this->slots.assign(slotCount, Slot{0, nullptr});
+			this->shift = 64 - std::countr_zero(slotCount);
+			this->count = 0;
+		}
+
+		/** Frees every slot, which disables the index. */
+		void disable() {
+			std::vector<Slot, SlotAllocator>(this->slots.get_allocator()).swap(this->slots);
+			this->shift = 64;
+			this->count = 0;
+		}
+
+		/** Returns the item with this hash for which `matches(item)` holds, or `nullptr`. */
+		template <typename Matches>
+		T * find(size_t hash, Matches &&matches) const {
+			size_t mask = this->slots.size() - 1;
+			for (size_t i = this->home(hash); this->slots[i].item; i = (i + 1) & mask) {
+				if (this->slots[i].hash == hash && matches(static_cast<const T *>(this->slots[i].item))) {
+					return this->slots[i].item;
+				}
+			}
+			return nullptr;
+		}
+
+		/** Adds an item, which must not be in the index yet. */
+		void insert(size_t hash, T *item) {
+			if (4 * (this->count + 1) > 3 * this->slots.size()) {
+				this->resize(2 * this->slots.size());
+			}
+			this->place(Slot{hash, item});
+			++this->count;
+		}
+
+		/** Removes the item, which is found by its hash and then by its address. */
+		void erase(size_t hash, const T *item) {
+			size_t mask = this->slots.size() - 1;
+			size_t i = this->home(hash);
+			while (this->slots[i].item != item) {
+				if (!this->slots[i].item) {return;}
+				i = (i + 1) & mask;
+			}
+
+			/**	Moves back every later item of the same run that may sit in the
+			 *	emptied slot, which is any item whose home slot is not between
+			 *	the emptied slot and its own slot. */
+			for (size_t j = (i + 1) & mask; this->slots[j].item; j = (j + 1) & mask) {
+				size_t home = this->home(this->slots[j].hash);
+				if (((j - home) & mask) >= ((j - i) & mask)) {
+					this->slots[i] = this->slots[j];
+					i = j;
+				}
+			}
+			this->slots[i] = Slot{0, nullptr};
+			--this->count;
+		}
+
+		/** Removes every item, keeping the slots. */
+		void clear() {
+			std::fill(this->slots.begin(), this->slots.end(), Slot{0, nullptr});
+			this->count = 0;
+		}
+
+		size_t size() const {return this->count;}
+
+		/** Number of bytes held by the slots, which is `0` while the index is disabled. */
+		size_t memoryUsage() const {return this->slots.capacity() * sizeof(Slot);}
+
+	private:
+		struct Slot {
+			size_t hash;
+			T *item;
+		};
+
+		using SlotAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+
+		std::vector<Slot, SlotAllocator> slots;
+		size_t count;
+
+		/** `64 - log2(slots.size())`, so that the top bits of a mixed hash pick a slot. */
+		unsigned shift;
+
+		/**
+		 *	The slot where probing for a hash starts. The hash is multiplied by
+		 *	`2^64` divided by the golden ratio first, which spreads hashes that
+		 *	differ only in their upper or lower bits, such as those of integers.
+		 */
+		size_t home(size_t hash) const {
+			return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ull) >> this->shift);
+		}
+
+		void place(Slot slot) {
+			size_t mask = this->slots.size() - 1;
+			size_t i = this->home(slot.hash);
+			while (this->slots[i].item) {i = (i + 1) & mask;}
+			this->slots[i] = slot;
+		}
+
+		/** Moves every item into `slotCount` new slots, which is a power of two. */
+		void resize(size_t slotCount) {
+			std::vector<Slot, SlotAllocator> old(slotCount, Slot{0, nullptr}, this->slots.get_allocator());
+			old.swap(this->slots);
+			this->shift = 64 - std::countr_zero(slotCount);
+			for (const Slot &slot : old) {
+				if (slot.item) {this->place(slot);}
+			}
+		}
+};
+
+#endif // HASHINDEX_H
@@ -0,0 +1,98 @@
+/**
+ *	MappedAVLTree.cpp
+ *
+ *	The method definitions of `BasicMappedAVLTree` live in `MappedAVLTree.tpp`.
+ *	The snapshot format, which `BasicAVLTree::save()` shares, is defined here,
+ *	and the default view, `MappedAVLTree`, is instantiated once here.
+ */
+
+#include "MappedAVLTree.h"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/stat.h>
+
+/** Places the sections of a snapshot of `count` keys, of `keyBytes` bytes in total, after the header. */
+AVLTreeSnapshot::Layout AVLTreeSnapshot::layoutOf(uint64_t count, uint64_t keyBytes, size_t valueSize) {
+	Layout layout;
+	layout.offsets = AVLTreeSnapshot::padded(sizeof(Header));
+	layout.values = layout.offsets + (count + 1) * sizeof(uint64_t);
+	layout.keys = layout.values + AVLTreeSnapshot::padded(count * valueSize);
+	layout.end = layout.keys + AVLTreeSnapshot::padded(keyBytes);
+	return layout;
+}
+
+/**
+ *	A 64-bit checksum of `bytes` bytes, which must be a multiple of 8.
+ *
+ *	Every 8 bytes are mixed into the state with one multiplication, so that
+ *	a snapshot is checked at close to the speed it is read from memory. This
+ *	detects corrupted and truncated files, but it is not a cryptographic hash.
+ */
+uint64_t AVLTreeSnapshot::checksum(const void *data, size_t bytes) {
+	const unsigned char *next = static_cast<const unsigned char *>(data);
+	uint64_t state = 0x9e3779b97f4a7c15 ^ bytes;
+	for (size_t i = 0; i + 8 <= bytes; i += 8) {
+		uint64_t word;
+		std::memcpy(&word, next + i, sizeof(word));
+		state = std::rotl(state ^ (word * 0xff51afd7ed558ccd), 31) * 0xc4ceb9fe1a85ec53;
+	}
+	state ^= state >> 33;
+	state *= 0xff51afd7ed558ccd;
+	state ^= state >> 33;
+	return state;
+}
+
+/**
+ *	Writes a whole snapshot to a temporary file next to `path`, flushes it to
+ *	the disk, and then renames it to `path`. A crash leaves either the old
+ *	file or the new one, and views of the old file stay valid.
+ *
+ *	The temporary file gets a unique name in the directory of `path`, so that
+ *	two trees saved to the same path at once don't write into the same file,
+ *	and the rename stays within one file system. The directory is flushed
+ *	after the rename, so that the new name survives a crash as well.
+ *
+ *	@return `true` if the snapshot was written, or `false` if any step failed.
+ *	The file at `path` is unchanged unless only flushing the directory failed,
+ *	in which case the new file is in place but may not outlast a crash.
+ */
+bool AVLTreeSnapshot::writeFile(const std::string &path, const void *data, size_t bytes) {
+	std::string temporary = path + ".XXXXXX";
+	int fd = ::mkostemp(temporary.data(), O_CLOEXEC);
+	if (fd < 0) {
+		return false;
+	}
+
+	const char *next = static_cast<const char *>(data);
+	bool written = ::fchmod(fd, 0644) == 0;
+	while (written && bytes > 0) {
+		ssize_t chunk = ::write(fd, next, bytes);
+		if (chunk < 0 && errno == EINTR) {continue;}
+		written = chunk > 0;
+		if (written) {
+			next += chunk;
+			bytes -= chunk;
+		}
+	}
+	written = written && ::fsync(fd) == 0;
+	written = (::close(fd) == 0) && written;
+
+	if (!written || std::rename(temporary.c_str(), path.c_str()) != 0) {
+		std::remove(temporary.c_str());
+		return false;
+	}
+
+	size_t slash = path.rfind('/');
+	std::string directory = (slash == std::string::npos) ? "." : path.substr(0, std::max<size_t>(slash, 1));
+	int dirFd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (dirFd < 0) {
+		return false;
+	}
+	bool synced = ::fsync(dirFd) == 0;
+	return (::close(dirFd) == 0) && synced;
+}
+
+template class BasicMappedAVLTree<>;
@@ -0,0 +1,172 @@
+/**
+ *	MappedAVLTree.h
+ */
+
+#ifndef MAPPEDAVLTREE_H
+#define MAPPEDAVLTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/**
+ *	The binary snapshot format written by `BasicAVLTree::save()`.
+ *
+ *	A snapshot is a `Header`, followed by three sections, each padded with
+ *	zeros to a multiple of 8 bytes:
+ *
+ *	1. `count + 1` offsets of type `uint64_t`, where key `i` takes the bytes
+ *	   `[offsets[i], offsets[i + 1])` of the key blob.
+ *	2. `count` values, stored as their bytes.
+ *	3. The key blob, holding all keys one after the other in ascending order.
+ *
+ *	All integers are in the byte order of the machine that wrote the file. A
+ *	file from a machine of the other byte order has an unknown version, and
+ *	is rejected as such. The checksum covers everything after the header.
+ */
+struct AVLTreeSnapshot {
+	static constexpr char MAGIC[8] = {'A', 'V', 'L', 'S', 'N', 'A', 'P', '\0'};
+	static constexpr uint32_t VERSION = 1;
+
+	struct Header {
+		char magic[8];
+		uint32_t version;
+
+		/** `sizeof` the value type, so that a file is never read as holding other values. */
+		uint32_t valueSize;
+
+		uint64_t count;
+		uint64_t keyBytes;
+		uint64_t checksum;
+	};
+
+	/** Byte offsets of the sections of a snapshot, from the start of the file. */
+	struct Layout {
+		size_t offsets;
+		size_t values;
+		size_t keys;
+		size_t end;
+	};
+
+	static size_t padded(size_t bytes) {return (bytes + 7) & ~size_t{7};}
+	static Layout layoutOf(uint64_t count, uint64_t keyBytes, size_t valueSize);
+
+	static uint64_t checksum(const void *data, size_t bytes);
+	static bool writeFile(const std::string &path, const void *data, size_t bytes);
+};
+
+/**
+ *	A read-only map of `std::string` keys and trivially copyable values, served
+ *	straight from a snapshot file that is mapped into memory.
+ *
+ *	Opening a snapshot checks its header, its checksum, and the order of its
+ *	keys in one pass over the file, and builds nothing. Lookups are binary
+ *	searches over the sorted keys of the file. Keys are ordered by their
+ *	bytes, like `std::less<std::string>`.
+ *
+ *	`BasicAVLTree::save()` replaces a file by renaming a new one over it, so
+ *	a view stays valid while the tree is saved again to the same path.
+ */
+template <typename Value = size_t>
+class BasicMappedAVLTree {
+	static_assert(std::is_trivially_copyable_v<Value>, "Snapshot values are stored as their bytes");
+	static_assert(alignof(Value) <= 8, "Snapshot sections are only aligned to 8 bytes");
+
+	public:
+		using KeyType = std::string;
+		using ValueType = Value;
+
+		/** A key-value pair of the snapshot. The key points into the mapped file. */
+		struct Entry {
+			std::string_view key;
+			ValueType value;
+		};
+
+		/** Forward iterator over the entries of the snapshot, in ascending order of the keys. */
+		class Iterator {
+			public:
+				using value_type = Entry;
+				using difference_type = std::ptrdiff_t;
+
+				Iterator() : tree(nullptr), index(0) {}
+
+				Entry operator*() const {return {this->tree->keyAt(this->index), this->tree->valueAt(this->index)};}
+
+				Iterator & operator++() {
+					++this->index;
+					return *this;
+				}
+				Iterator operator++(int) {
+					Iterator old = *this;
+					++this->index;
+					return old;
+				}
+
+				bool operator==(const Iterator &other) const {return this->index == other.index;}
+				difference_type operator-(const Iterator &other) const {
+					return static_cast<difference_type>(this->index) - static_cast<difference_type>(other.index);
+				}
+
+			private:
+				friend class BasicMappedAVLTree;
+
+				const BasicMappedAVLTree *tree;
+				size_t index;
+
+				Iterator(const BasicMappedAVLTree *tree, size_t index) : tree(tree), index(index) {}
+		};
+
+		BasicMappedAVLTree();
+		BasicMappedAVLTree(BasicMappedAVLTree &&other) noexcept;
+		~BasicMappedAVLTree();
+		BasicMappedAVLTree & operator=(BasicMappedAVLTree &&other) noexcept;
+
+		BasicMappedAVLTree(const BasicMappedAVLTree &) = delete;
+		BasicMappedAVLTree & operator=(const BasicMappedAVLTree &) = delete;
+
+		bool open(const std::string &path);
+		void close();
+		bool isOpen() const;
+
+		bool contains(std::string_view key) const;
+		std::optional<ValueType> get(std::string_view key) const;
+
+		std::vector<KeyType> keys() const;
+		std::vector<ValueType> findRange(std::string_view low, std::string_view high) const;
+
+		template <typename Visitor>
+		void visitRange(std::string_view low, std::string_view high, Visitor &&visit) const;
+
+		size_t size() const;
+
+		Iterator begin() const {return Iterator(this, 0);}
+		Iterator end() const {return Iterator(this, this->count);}
+
+	private:
+		const char *mapping;
+		size_t mappingBytes;
+
+		size_t count;
+		const uint64_t *offsets;
+		const char *values;
+		const char *keyBlob;
+
+		std::string_view keyAt(size_t i) const;
+		ValueType valueAt(size_t i) const;
+
+		/** Index of the first key that is not less than `key`, or that is greater than `key` if `upper` is set. */
+		size_t boundOf(std::string_view key, bool upper) const;
+};
+
+#include "MappedAVLTree.tpp"
+
+/** The mapped snapshot of `std::string` keys and `size_t` values, which is instantiated once in `MappedAVLTree.cpp`. */
+using MappedAVLTree = BasicMappedAVLTree<>;
+
+extern template class BasicMappedAVLTree<>;
+
+#endif // MAPPEDAVLTREE_H
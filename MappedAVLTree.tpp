@@ -0,0 +1,253 @@
+/**
+ *	MappedAVLTree.tpp
+ *
+ *	Contains all method definitions of the class template declared in
+ *	`MappedAVLTree.h`, which includes this file.
+ */
+
+#include <cstring>
+#include <unordered_set>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+template <typename Value>
+BasicMappedAVLTree<Value>::BasicMappedAVLTree() :
+	mapping(nullptr), mappingBytes(0),
+	count(0), offsets(nullptr), values(nullptr), keyBlob(nullptr) {}
+
+template <typename Value>
+BasicMappedAVLTree<Value>::BasicMappedAVLTree(BasicMappedAVLTree &&other) noexcept :
+	mapping(std::exchange(other.mapping, nullptr)), mappingBytes(std::exchange(other.mappingBytes, 0)),
+	count(std::exchange(other.count, 0)), offsets(std::exchange(other.offsets, nullptr)),
+	values(std::exchange(other.values, nullptr)), keyBlob(std::exchange(other.keyBlob, nullptr)) {}
+
+template <typename Value>
+BasicMappedAVLTree<Value>::~BasicMappedAVLTree() {
+	this->close();
+}
+
+template <typename Value>
+BasicMappedAVLTree<Value> & BasicMappedAVLTree<Value>::operator=(BasicMappedAVLTree &&other) noexcept {
+	if (this != &other) {
+		this->close();
+		this->mapping = std::exchange(other.mapping, nullptr);
+		this->mappingBytes = std::exchange(other.mappingBytes, 0);
+		this->count = std::exchange(other.count, 0);
+		this->offsets = std::exchange(other.offsets, nullptr);
+		this->values = std::exchange(other.values, nullptr);
+		this->keyBlob = std::exchange(other.keyBlob, nullptr);
+	}
+	return *this;
+}
+
+/**
+ *	Maps the snapshot at `path` into memory, in place of any snapshot that
+ *	was open before. The file is rejected if it is not a snapshot of this
+ *	format version and value type, if its checksum doesn't match, or if its
+ *	keys are not in strictly ascending order.
+ *
+ *	@return `true` if the snapshot was opened, or `false` if it could not be
+ *	read or was rejected, which leaves the view closed.
+ *
+ *	Expected time complexity is `O(n + k)` for `n` keys of `k` bytes in total.
+ */
+template <typename Value>
+bool BasicMappedAVLTree<Value>::open(const std::string &path) {
+	this->close();
+
+	int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat status;
+	if (::fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(AVLTreeSnapshot::Header)) {
+		::close(fd);
+		return false;
+	}
+
+	size_t bytes = static_cast<size_t>(status.st_size);
+	void *mapped = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (mapped == MAP_FAILED) {
+		return false;
+	}
+	this->mapping = static_cast<const char *>(mapped);
+	this->mappingBytes = bytes;
+
+	AVLTreeSnapshot::Header header;
+	std::memcpy(&header, this->mapping, sizeof(header));
+	if (
+		std::memcmp(header.magic, AVLTreeSnapshot::MAGIC, sizeof(header.magic)) != 0 ||
+		header.version != AVLTreeSnapshot::VERSION || header.valueSize != sizeof(ValueType) ||
+		header.count > bytes / sizeof(uint64_t) || header.keyBytes > bytes
+	) {
+		this->close();
+		return false;
+	}
+
+	AVLTreeSnapshot::Layout layout = AVLTreeSnapshot::layoutOf(header.count, header.keyBytes, sizeof(ValueType));
+	if (
+		layout.end != bytes ||
+		AVLTreeSnapshot::checksum(this->mapping + layout.offsets, bytes - layout.offsets) != header.checksum
+	) {
+		this->close();
+		return false;
+	}
+
+	this->count = header.count;
+	this->offsets = reinterpret_cast<const uint64_t *>(this->mapping + layout.offsets);
+	this->values = this->mapping + layout.values;
+	this->keyBlob = this->mapping + layout.keys;
+
+	bool valid = this->offsets[0] == 0 && this->offsets[this->count] == header.keyBytes;
+	for (size_t i = 0; valid && i < this->count; ++i) {
+		valid = this->offsets[i] <= this->offsets[i + 1] && this->offsets[i + 1] <= header.keyBytes;
+		if (valid && i > 0) {valid = this->keyAt(i - 1) < this->keyAt(i);}
+	}
+	if (!valid) {
+		this->close();
+		return false;
+	}
+	return true;
+}
+
+/** Unmaps the snapshot, after which the view is empty. */
+template <typename Value>
+void BasicMappedAVLTree<Value>::close() {
+	if (this->mapping) {
+		::munmap(const_cast<char *>(this->mapping), this->mappingBytes);
+	}
+	this->mapping = nullptr;
+	this->mappingBytes = 0;
+	this->count = 0;
+	this->offsets = nullptr;
+	this->values = nullptr;
+	this->keyBlob = nullptr;
+}
+
+template <typename Value>
+bool BasicMappedAVLTree<Value>::isOpen() const {
+	return this->mapping != nullptr;
+}
+
+/**
+ *	Checks whether the snapshot holds the key.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Value>
+bool BasicMappedAVLTree<Value>::contains(std::string_view key) const {
+	size_t i = this->boundOf(key, false);
+	return i < this->count && this->keyAt(i) == key;
+}
+
+/**
+ *	Gets the value of a key.
+ *
+ *	@return The value, or nothing if the snapshot doesn't hold the key.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Value>
+std::optional<typename BasicMappedAVLTree<Value>::ValueType> BasicMappedAVLTree<Value>::get(std::string_view key) const {
+	size_t i = this->boundOf(key, false);
+	if (i < this->count && this->keyAt(i) == key) {
+		return this->valueAt(i);
+	}
+	return std::nullopt;
+}
+
+/**
+ *	Copies all keys of the snapshot, in ascending order.
+ *
+ *	Expected time complexity is `O(n)`.
+ */
+template <typename Value>
+std::vector<typename BasicMappedAVLTree<Value>::KeyType> BasicMappedAVLTree<Value>::keys() const {
+	std::vector<KeyType> keyList;
+	keyList.reserve(this->count);
+	for (size_t i = 0; i < this->count; ++i) {keyList.emplace_back(this->keyAt(i));}
+	return keyList;
+}
+
+/**
+ *	Gets the values of all keys in `[low, high]`, in ascending order of the keys.
+ *	Like `AVLTree::findRange`, a value that occurs more than once is only
+ *	returned the first time, unless values have no `std::hash`.
+ *
+ *	Expected time complexity is `O(log(n) + m)`, where `m` is the number of keys in the range.
+ */
+template <typename Value>
+std::vector<typename BasicMappedAVLTree<Value>::ValueType> BasicMappedAVLTree<Value>::findRange(std::string_view low, std::string_view high) const {
+	std::vector<ValueType> valueList;
+	if constexpr (requires (const ValueType &value) {std::hash<ValueType>{}(value);}) {
+		std::unordered_set<ValueType> seen;
+		this->visitRange(low, high, [&](std::string_view, const ValueType &value) {
+			if (seen.insert(value).second) {valueList.push_back(value);}
+		});
+	} else {
+		this->visitRange(low, high, [&valueList](std::string_view, const ValueType &value) {
+			valueList.push_back(value);
+		});
+	}
+	return valueList;
+}
+
+/**
+ *	Calls `visit(key, value)` for every key in `[low, high]`, in ascending
+ *	order, without copying any key.
+ *
+ *	Expected time complexity is `O(log(n) + m)`, where `m` is the number of keys in the range.
+ */
+template <typename Value>
+template <typename Visitor>
+void BasicMappedAVLTree<Value>::visitRange(std::string_view low, std::string_view high, Visitor &&visit) const {
+	if (high < low) {
+		return;
+	}
+
+	size_t last = this->boundOf(high, true);
+	for (size_t i = this->boundOf(low, false); i < last; ++i) {
+		visit(this->keyAt(i), this->valueAt(i));
+	}
+}
+
+template <typename Value>
+size_t BasicMappedAVLTree<Value>::size() const {
+	return this->count;
+}
+
+template <typename Value>
+std::string_view BasicMappedAVLTree<Value>::keyAt(size_t i) const {
+	return std::string_view(this->keyBlob + this->offsets[i], this->offsets[i + 1] - this->offsets[i]);
+}
+
+/** The file holds the bytes of the values rather than objects, so each value is copied out. */
+template <typename Value>
+typename BasicMappedAVLTree<Value>::ValueType BasicMappedAVLTree<Value>::valueAt(size_t i) const {
+	ValueType value;
+	std::memcpy(&value, this->values + i * sizeof(ValueType), sizeof(ValueType));
+	return value;
+}
+
+/** Binary search over the sorted keys of the snapshot. */
+template <typename Value>
+size_t BasicMappedAVLTree<Value>::boundOf(std::string_view key, bool upper) const {
+	size_t first = 0;
+	size_t n = this->count;
+	while (n > 0) {
+		size_t half = n / 2;
+		int cmp = this->keyAt(first + half).compare(key);
+		if (cmp < 0 || (upper && cmp == 0)) {
+			first += half + 1;
+			n -= half + 1;
+		} else {
+			n = half;
+		}
+	}
+	return first;
+}
@@ -0,0 +1,311 @@
+/**
+ *	NodePool.h
+ *
+ *	Slab allocator for the nodes of a tree.
+ */
+
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ *	Counters describing how a `NodePool` has been used since it was created.
+ *	In a steady state of insertions and removals, `slabAllocations` stops
+ *	growing, since every freed node is handed out again.
+ */
+struct NodePoolStats {
+
+	/** Number of calls into the underlying allocator. */
+	size_t slabAllocations = 0;
+
+	/** Number of nodes that can be held by all the slabs. */
+	size_t capacity = 0;
+
+	/** Number of nodes constructed. */
+	size_t nodesCreated = 0;
+
+	/** Number of nodes handed out again from the free list. */
+	size_t nodesReused = 0;
+
+	/** Number of nodes destroyed one at a time. */
+	size_t nodesDestroyed = 0;
+
+	/** Number of nodes that are currently alive. */
+	size_t live = 0;
+};
+
+/**
+ *	Nodes are carved out of slabs, which are large blocks holding many nodes at
+ *	once. Each new slab is twice as large as the previous one, until it reaches
+ *	`MAX_SLAB` nodes.
+ *
+ *	A destroyed node is pushed onto an intrusive free list, where the storage of
+ *	that node holds the link to the next free node. Later nodes are created from
+ *	the free list before the current slab is used up.
+ *
+ *	All slabs are returned to the underlying allocator at once by `release()`,
+ *	instead of freeing every node on its own.
+ *
+ *	When the nodes of a tree are divided between two trees, their slabs are
+ *	shared by the pools of both trees, and the last pool to let go of them
+ *	returns them to the allocator. When two trees are joined, one pool takes
+ *	over the slabs of the other.
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class NodePool {
+	public:
+		static constexpr size_t FIRST_SLAB = 32;
+		static constexpr size_t MAX_SLAB = 4096;
+
+		explicit NodePool(const Allocator &alloc = Allocator()) :
+			alloc(alloc), slabs(nullptr), freeList(nullptr), freeTail(nullptr),
+			cursor(nullptr), end(nullptr), nextSlab(FIRST_SLAB) {}
+
+		NodePool(const NodePool &) = delete;
+		NodePool & operator=(const NodePool &) = delete;
+
+		NodePool(NodePool &&other) noexcept :
+			alloc(std::move(other.alloc)), slabs(std::exchange(other.slabs, nullptr)),
+			freeList(std::exchange(other.freeList, nullptr)),
+			freeTail(std::exchange(other.freeTail, nullptr)),
+			cursor(std::exchange(other.cursor, nullptr)), end(std::exchange(other.end, nullptr)),
+			nextSlab(std::exchange(other.nextSlab, FIRST_SLAB)),
+			counters(std::exchange(other.counters, NodePoolStats{})),
+			sharedSlabs(std::move(other.sharedSlabs)) {}
+
+		NodePool & operator=(NodePool &&other) noexcept {
+			if (this != &other) {
+				this->release();
+				this->alloc = std::move(other.alloc);
+				this->slabs = std::exchange(other.slabs, nullptr);
+				this->freeList = std::exchange(other.freeList, nullptr);
+				this->freeTail = std::exchange(other.freeTail, nullptr);
+				this->cursor = std::exchange(other.cursor, nullptr);
+				this->end = std::exchange(other.end, nullptr);
+				this->nextSlab = std::exchange(other.nextSlab, FIRST_SLAB);
+				this->counters = std::exchange(other.counters, NodePoolStats{});
+				this->sharedSlabs = std::move(other.sharedSlabs);
+			}
+			return *this;
+		}
+
+		/** Any node that is still alive must have been destroyed by its owner. */
+		~NodePool() {this->release();}
+
+		/**
+		 *	Constructs a node in the first free slot.
+		 *	A new slab is only allocated once the free list and the current slab are empty.
+		 */
+		template <typename... Args>
+		T * create(Args &&...args) {
+			Slot *slot;
+			if (this->freeList) {
+				slot = this->freeList;
+				this->freeList = this->freeList->next;
+				++this->counters.nodesReused;
+			} else {
+				if (this->cursor == this->end) {this->grow();}
+				slot = this->cursor++;
+			}
+
+			T *node = ::new (static_cast<void *>(slot)) T(std::forward<Args>(args)...);
+			++this->counters.nodesCreated;
+			++this->counters.live;
+			return node;
+		}
+
+		/**
+		 *	Makes sure the next `count` nodes can be created without another call
+		 *	into the underlying allocator. Nodes on the free list are not counted,
+		 *	and a single slab of at least `count` nodes is allocated if needed.
+		 */
+		void reserve(size_t count) {
+			if (static_cast<size_t>(this->end - this->cursor) < count) {
+				this->grow(std::max(count, this->nextSlab));
+			}
+		}
+
+		/** Destroys a node and pushes its storage onto the free list. */
+		void destroy(T *node) {
+			std::destroy_at(node);
+			Slot *slot = reinterpret_cast<Slot *>(node);
+			slot->next = this->freeList;
+			if (!this->freeList) {this->freeTail = slot;}
+			this->freeList = slot;
+			++this->counters.nodesDestroyed;
+			--this->counters.live;
+		}
+
+		/**
+		 *	Returns a pool that becomes the owner of `liveNodes` of the nodes of
+		 *	this pool. From then on, the slabs of this pool are shared by both
+		 *	pools, and each pool destroys its own nodes onto its own free list.
+		 *
+		 *	The new pool allocates slabs of its own once it needs more nodes.
+		 */
+		NodePool split(size_t liveNodes) {
+			if (this->slabs) {
+				this->sharedSlabs.push_back(std::shared_ptr<SlabHeader>(
+					std::exchange(this->slabs, nullptr), SlabReleaser{this->alloc}
+				));
+			}
+
+			NodePool other(this->alloc);
+			other.sharedSlabs = this->sharedSlabs;
+			other.counters.live = liveNodes;
+			this->counters.live -= liveNodes;
+			return other;
+		}
+
+		/**
+		 *	Takes over every slab and free node of the `other` pool, which is left
+		 *	empty. The nodes created by the `other` pool are destroyed by this one
+		 *	from then on. Both pools must use equal allocators.
+		 *
+		 *	Only the slabs of the `other` pool are walked, so a pool adopting many
+		 *	small pools in turn does so in time proportional to their slabs.
+		 */
+		void adopt(NodePool &&other) {
+			if (other.slabs) {
+				SlabHeader *last = other.slabs;
+				while (last->next) {last = last->next;}
+				last->next = this->slabs;
+				this->slabs = std::exchange(other.slabs, nullptr);
+			}
+
+			if (other.freeList) {
+				if (this->freeList) {
+					this->freeTail->next = other.freeList;
+				} else {
+					this->freeList = other.freeList;
+				}
+				this->freeTail = other.freeTail;
+				other.freeList = nullptr;
+				other.freeTail = nullptr;
+			}
+
+			for (std::shared_ptr<SlabHeader> &shared : other.sharedSlabs) {
+				if (std::find(this->sharedSlabs.begin(), this->sharedSlabs.end(), shared) == this->sharedSlabs.end()) {
+					this->sharedSlabs.push_back(std::move(shared));
+				}
+			}
+			other.sharedSlabs.clear();
+
+			if (this->cursor == this->end) {
+				this->cursor = other.cursor;
+				this->end = other.end;
+			}
+			other.cursor = nullptr;
+			other.end = nullptr;
+
+			this->counters.slabAllocations += other.counters.slabAllocations;
+			this->counters.capacity += other.counters.capacity;
+			this->counters.live += other.counters.live;
+			other.counters = NodePoolStats{};
+		}
+
+		/**
+		 *	Returns every slab to the underlying allocator.
+		 *	The nodes living in those slabs are not destroyed here, so the owner
+		 *	must have destroyed them beforehand if they are not trivially destructible.
+		 */
+		void release() {
+			SlabReleaser{this->alloc}(std::exchange(this->slabs, nullptr));
+			this->sharedSlabs.clear();
+
+			this->freeList = nullptr;
+			this->freeTail = nullptr;
+			this->cursor = nullptr;
+			this->end = nullptr;
+			this->nextSlab = FIRST_SLAB;
+			this->counters.capacity = 0;
+			this->counters.live = 0;
+		}
+
+		const NodePoolStats & stats() const {return this->counters;}
+
+		/** Starts the counters over, except for `capacity` and `live`, which describe the pool as it is now. */
+		void resetStats() {
+			this->counters = NodePoolStats{.capacity = this->counters.capacity, .live = this->counters.live};
+		}
+
+		Allocator get_allocator() const {return this->alloc;}
+
+	private:
+
+		/** Storage for one node, which doubles as a link while the node is free. */
+		union Slot {
+			Slot *next;
+			alignas(T) std::byte storage[sizeof(T)];
+		};
+
+		/** Each slab starts with a header linking it to the previously allocated slab. */
+		struct SlabHeader {
+			SlabHeader *next;
+			size_t slots;
+		};
+
+		using SlotAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+
+		/** Returns a list of slabs to the underlying allocator. */
+		struct SlabReleaser {
+			Allocator alloc;
+
+			void operator()(SlabHeader *slabs) const {
+				SlotAllocator slotAlloc(this->alloc);
+				while (slabs) {
+					SlabHeader *header = slabs;
+					slabs = header->next;
+					std::allocator_traits<SlotAllocator>::deallocate(
+						slotAlloc, reinterpret_cast<Slot *>(header), header->slots
+					);
+				}
+			}
+		};
+
+		static constexpr size_t HEADER_SLOTS = (sizeof(SlabHeader) + sizeof(Slot) - 1) / sizeof(Slot);
+
+		Allocator alloc;
+		SlabHeader *slabs;
+		Slot *freeList;
+
+		/** The last node of the free list, which is only meaningful while the list isn't empty. */
+		Slot *freeTail;
+
+		Slot *cursor;
+		Slot *end;
+		size_t nextSlab;
+		NodePoolStats counters;
+
+		/** Lists of slabs that this pool shares with the pools it was split from or into. */
+		std::vector<std::shared_ptr<SlabHeader>> sharedSlabs;
+
+		void grow() {this->grow(this->nextSlab);}
+
+		/**
+		 *	Allocates a slab of `nodeCount` nodes. Whatever is left of the current
+		 *	slab stays unused until the slabs are released.
+		 */
+		void grow(size_t nodeCount) {
+			SlotAllocator slotAlloc(this->alloc);
+			size_t slots = HEADER_SLOTS + nodeCount;
+			Slot *block = std::allocator_traits<SlotAllocator>::allocate(slotAlloc, slots);
+
+			SlabHeader *header = ::new (static_cast<void *>(block)) SlabHeader{this->slabs, slots};
+			this->slabs = header;
+			this->cursor = block + HEADER_SLOTS;
+			this->end = block + slots;
+
+			++this->counters.slabAllocations;
+			this->counters.capacity += nodeCount;
+			if (this->nextSlab < MAX_SLAB) {this->nextSlab *= 2;}
+		}
+};
+
+#endif // NODEPOOL_H
@@ -0,0 +1,11 @@
+/**
+ *	PersistentAVLTree.cpp
+ *
+ *	The method definitions of `BasicPersistentAVLTree` live in
+ *	`PersistentAVLTree.tpp`. The default tree, `PersistentAVLTree`, is
+ *	instantiated once here.
+ */
+
+#include "PersistentAVLTree.h"
+
+template class BasicPersistentAVLTree<>;
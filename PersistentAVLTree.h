@@ -0,0 +1,154 @@
+/**
+ *	PersistentAVLTree.h
+ */
+
+#ifndef PERSISTENTAVLTREE_H
+#define PERSISTENTAVLTREE_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/**
+ *	An AVL tree whose nodes are never modified once they are published.
+ *
+ *	An insertion or removal copies only the nodes on the path from the root to
+ *	the changed node, and every other node is shared with the previous version.
+ *	The new root is then published through a `std::atomic<std::shared_ptr>`.
+ *	Writers are serialized by a mutex, which readers never take.
+ *
+ *	Readers take a `Snapshot`, which is an immutable version of the tree.
+ *	Taking a snapshot is not lock-free: the standard library guards the shared
+ *	root with a spin lock, which a writer publishing a version, and every other
+ *	reader taking a snapshot, hold for the few instructions it takes to copy
+ *	the pointer and count the reference. All lookups and scans on a snapshot
+ *	then run without any lock, and they are neither held back by writers nor
+ *	hold them back.
+ *
+ *	The tree itself has no lookups, since taking a snapshot for every lookup
+ *	would make all readers contend for that spin lock and for the reference
+ *	count of the root. A reader should instead keep a snapshot for many
+ *	lookups, and take a new one when it needs to see later writes.
+ *
+ *	Nodes are reference counted, so a version is reclaimed as soon as the last
+ *	snapshot referring to its nodes is destroyed. Whichever thread drops that
+ *	last reference frees the nodes that no newer version shares, which may be
+ *	a reader that held an old snapshot while many writes went by.
+ *
+ *	Copying the tree or a snapshot shares the root, so it takes `O(1)` time.
+ */
+template <typename Key = std::string, typename Value = size_t, typename Compare = std::less<>>
+class BasicPersistentAVLTree {
+	private:
+		struct Node;
+		using NodePtr = std::shared_ptr<const Node>;
+
+		struct Node {
+			const Key key;
+			const Value value;
+			const size_t height;
+
+			/** Number of nodes in the subtree rooted at this node, including itself. */
+			const size_t count;
+
+			const NodePtr left;
+			const NodePtr right;
+		};
+
+	public:
+		using KeyType = Key;
+		using ValueType = Value;
+
+		/** An immutable version of the tree. */
+		class Snapshot {
+			public:
+				Snapshot() = default;
+
+				bool contains(const KeyType &key) const;
+				std::optional<ValueType> get(const KeyType &key) const;
+
+				std::vector<KeyType> keys() const;
+				std::vector<ValueType> findRange(const KeyType &low, const KeyType &high) const;
+
+				template <typename Visitor>
+				void visitRange(const KeyType &low, const KeyType &high, Visitor &&visit) const;
+
+				size_t size() const;
+				size_t getHeight() const;
+
+			private:
+				friend class BasicPersistentAVLTree;
+
+				NodePtr root;
+				Compare comp;
+
+				Snapshot(NodePtr root, const Compare &comp) : root(std::move(root)), comp(comp) {}
+
+				const Node * findNode(const KeyType &key) const;
+
+				template <typename Visitor>
+				void visitRange(const Node *current, const KeyType &low, const KeyType &high, Visitor &visit) const;
+		};
+
+		explicit BasicPersistentAVLTree(const Compare &comp = Compare());
+		explicit BasicPersistentAVLTree(const Snapshot &snapshot);
+		BasicPersistentAVLTree(const BasicPersistentAVLTree &other);
+		BasicPersistentAVLTree & operator=(const BasicPersistentAVLTree &other);
+
+		bool insert(const KeyType &key, ValueType value);
+		bool remove(const KeyType &key);
+
+		Snapshot snapshot() const;
+
+	private:
+		std::atomic<NodePtr> root;
+		Compare comp;
+
+		/** Serializes the writers, so that no published version is lost. */
+		std::mutex writeMutex;
+
+		static constexpr bool USES_STRING_ORDER = std::is_same_v<Key, std::string> && (
+			std::is_same_v<Compare, std::less<>> || std::is_same_v<Compare, std::less<std::string>>
+		);
+
+		/**
+		 *	Three-way comparison of two keys.
+		 *
+		 *	@return A negative integer if `a < b`; `0` if `a == b`; or a positive integer if `a > b`.
+		 */
+		static int compareKeys(const Compare &comp, const KeyType &a, const KeyType &b) {
+			if constexpr (USES_STRING_ORDER) {
+				return std::string_view(a).compare(std::string_view(b));
+			} else {
+				return comp(a, b) ? -1 : (comp(b, a) ? 1 : 0);
+			}
+		}
+
+		static size_t heightOf(const NodePtr &node);
+		static size_t countOf(const NodePtr &node);
+
+		static NodePtr makeNode(const KeyType &key, const ValueType &value, NodePtr left, NodePtr right);
+		static NodePtr balance(const KeyType &key, const ValueType &value, NodePtr left, NodePtr right);
+
+		/* Recursive helper methods, which return the root of the new version of a subtree. */
+
+		NodePtr insert(const NodePtr &node, const KeyType &key, const ValueType &value, bool &inserted) const;
+		NodePtr remove(const NodePtr &node, const KeyType &key, bool &removed) const;
+		static NodePtr removeMin(const NodePtr &node, NodePtr &min);
+};
+
+#include "PersistentAVLTree.tpp"
+
+/** The persistent tree of `std::string` keys and `size_t` values, which is instantiated once in `PersistentAVLTree.cpp`. */
+using PersistentAVLTree = BasicPersistentAVLTree<>;
+
+extern template class BasicPersistentAVLTree<>;
+
+#endif // PERSISTENTAVLTREE_H
@@ -0,0 +1,350 @@
+/**
+ *	PersistentAVLTree.tpp
+ *
+ *	Contains all method definitions of the class template declared in
+ *	`PersistentAVLTree.h`, which includes this file.
+ */
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+template <typename Key, typename Value, typename Compare>
+BasicPersistentAVLTree<Key, Value, Compare>::BasicPersistentAVLTree(const Compare &comp) :
+	root(nullptr), comp(comp) {}
+
+/** Create a tree whose first version is the `snapshot`, sharing all its nodes. */
+template <typename Key, typename Value, typename Compare>
+BasicPersistentAVLTree<Key, Value, Compare>::BasicPersistentAVLTree(const Snapshot &snapshot) :
+	root(snapshot.root), comp(snapshot.comp) {}
+
+/**
+ *	Create a copy of another tree, which shares the current version of the
+ *	`other` tree. Later writes to either tree copy the nodes they change, so
+ *	the two trees stay independent.
+ *
+ *	Expected time complexity is `O(1)`.
+ */
+template <typename Key, typename Value, typename Compare>
+BasicPersistentAVLTree<Key, Value, Compare>::BasicPersistentAVLTree(const BasicPersistentAVLTree &other) :
+	root(other.root.load(std::memory_order_acquire)), comp(other.comp) {}
+
+template <typename Key, typename Value, typename Compare>
+BasicPersistentAVLTree<Key, Value, Compare> & BasicPersistentAVLTree<Key, Value, Compare>::operator=(const BasicPersistentAVLTree &other) {
+	if (this != &other) {
+		std::lock_guard lock(this->writeMutex);
+		this->comp = other.comp;
+		this->root.store(other.root.load(std::memory_order_acquire), std::memory_order_release);
+	}
+	return *this;
+}
+
+/**
+ *	Inserts the key-value pair into a new version of the tree, and publishes it.
+ *	If the key already exists, its value is updated in the new version, and
+ *	this returns `false`.
+ *
+ *	Expected time complexity is `O(log(n))`, which includes copying the
+ *	`O(log(n))` nodes on the path to the key.
+ */
+template <typename Key, typename Value, typename Compare>
+bool BasicPersistentAVLTree<Key, Value, Compare>::insert(const KeyType &key, ValueType value) {
+	std::lock_guard lock(this->writeMutex);
+	bool inserted = false;
+	NodePtr current = this->root.load(std::memory_order_relaxed);
+	this->root.store(this->insert(current, key, value, inserted), std::memory_order_release);
+	return inserted;
+}
+
+/**
+ *	Removes `key` from a new version of the tree, and publishes it.
+ *	If the key doesn't exist, no version is published, and this returns `false`.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare>
+bool BasicPersistentAVLTree<Key, Value, Compare>::remove(const KeyType &key) {
+	std::lock_guard lock(this->writeMutex);
+	bool removed = false;
+	NodePtr current = this->root.load(std::memory_order_relaxed);
+	NodePtr next = this->remove(current, key, removed);
+	if (removed) {
+		this->root.store(std::move(next), std::memory_order_release);
+	}
+	return removed;
+}
+
+/**
+ *	Returns the latest published version of the tree, which stays valid and
+ *	unchanged for as long as it is kept, and should serve many lookups.
+ *
+ *	Expected time complexity is `O(1)`.
+ */
+template <typename Key, typename Value, typename Compare>
+typename BasicPersistentAVLTree<Key, Value, Compare>::Snapshot BasicPersistentAVLTree<Key, Value, Compare>::snapshot() const {
+	return Snapshot(this->root.load(std::memory_order_acquire), this->comp);
+}
+
+template <typename Key, typename Value, typename Compare>
+size_t BasicPersistentAVLTree<Key, Value, Compare>::heightOf(const NodePtr &node) {
+	return node ? node->height : 0;
+}
+
+template <typename Key, typename Value, typename Compare>
+size_t BasicPersistentAVLTree<Key, Value, Compare>::countOf(const NodePtr &node) {
+	return node ? node->count : 0;
+}
+
+/**
+ *	Creates a node over two subtrees, whose heights differ by at most 1.
+ *	Heights are counted in nodes here, so a leaf has height `1`. The node is
+ *	constructed in place, since its const members can't be moved from a temporary.
+ */
+template <typename Key, typename Value, typename Compare>
+typename BasicPersistentAVLTree<Key, Value, Compare>::NodePtr BasicPersistentAVLTree<Key, Value, Compare>::makeNode(
+	const KeyType &key, const ValueType &value, NodePtr left, NodePtr right
+) {
+	size_t height = std::max(heightOf(left), heightOf(right)) + 1;
+	size_t count = countOf(left) + countOf(right) + 1;
+	return std::make_shared<const Node>(key, value, height, count, std::move(left), std::move(right));
+}
+
+/**
+ *	Creates a node over two subtrees whose heights may differ by 2, after one
+ *	of them grew or shrank. Instead of rotating existing nodes, a rotation is
+ *	made by creating the nodes that take new children, and sharing the rest.
+ */
+template <typename Key, typename Value, typename Compare>
+typename BasicPersistentAVLTree<Key, Value, Compare>::NodePtr BasicPersistentAVLTree<Key, Value, Compare>::balance(
+	const KeyType &key, const ValueType &value, NodePtr left, NodePtr right
+) {
+	size_t lh = heightOf(left);
+	size_t rh = heightOf(right);
+
+	if (lh > rh + 1) {
+		if (heightOf(left->left) >= heightOf(left->right)) {
+			return makeNode(left->key, left->value, left->left, makeNode(key, value, left->right, std::move(right)));
+		}
+		const Node &pivot = *left->right;
+		return makeNode(
+			pivot.key, pivot.value,
+			makeNode(left->key, left->value, left->left, pivot.left),
+			makeNode(key, value, pivot.right, std::move(right))
+		);
+	} else if (rh > lh + 1) {
+		if (heightOf(right->right) >= heightOf(right->left)) {
+			return makeNode(right->key, right->value, makeNode(key, value, std::move(left), right->left), right->right);
+		}
+		const Node &pivot = *right->left;
+		return makeNode(
+			pivot.key, pivot.value,
+			makeNode(key, value, std::move(left), pivot.left),
+			makeNode(right->key, right->value, pivot.right, right->right)
+		);
+	}
+	return makeNode(key, value, std::move(left), std::move(right));
+}
+
+template <typename Key, typename Value, typename Compare>
+typename BasicPersistentAVLTree<Key, Value, Compare>::NodePtr BasicPersistentAVLTree<Key, Value, Compare>::insert(
+	const NodePtr &node, const KeyType &key, const ValueType &value, bool &inserted
+) const {
+	if (!node) {
+		inserted = true;
+		return makeNode(key, value, nullptr, nullptr);
+	}
+
+	int cmp = compareKeys(this->comp, key, node->key);
+	if (cmp < 0) {
+		return balance(node->key, node->value, this->insert(node->left, key, value, inserted), node->right);
+	} else if (cmp > 0) {
+		return balance(node->key, node->value, node->left, this->insert(node->right, key, value, inserted));
+	}
+	return makeNode(node->key, value, node->left, node->right);
+}
+
+/** Subtrees that don't hold `key` are returned as they are, so nothing is copied for a missing key. */
+template <typename Key, typename Value, typename Compare>
+typename BasicPersistentAVLTree<Key, Value, Compare>::NodePtr BasicPersistentAVLTree<Key, Value, Compare>::remove(
+	const NodePtr &node, const KeyType &key, bool &removed
+) const {
+	if (!node) {
+		return nullptr;
+	}
+
+	int cmp = compareKeys(this->comp, key, node->key);
+	if (cmp < 0) {
+		NodePtr left = this->remove(node->left, key, removed);
+		return removed ? balance(node->key, node->value, std::move(left), node->right) : node;
+	} else if (cmp > 0) {
+		NodePtr right = this->remove(node->right, key, removed);
+		return removed ? balance(node->key, node->value, node->left, std::move(right)) : node;
+	}
+
+	removed = true;
+	if (!node->left) {
+		return node->right;
+	} else if (!node->right) {
+		return node->left;
+	}
+
+	/** The smallest node of the right subtree takes the place of the removed node. */
+	NodePtr min;
+	NodePtr right = removeMin(node->right, min);
+	return balance(min->key, min->value, node->left, std::move(right));
+}
+
+/** Returns a new version of the subtree without its smallest node, which is handed out through `min`. */
+template <typename Key, typename Value, typename Compare>
+typename BasicPersistentAVLTree<Key, Value, Compare>::NodePtr BasicPersistentAVLTree<Key, Value, Compare>::removeMin(
+	const NodePtr &node, NodePtr &min
+) {
+	if (!node->left) {
+		min = node;
+		return node->right;
+	}
+	return balance(node->key, node->value, removeMin(node->left, min), node->right);
+}
+
+/**
+ *	Returns `true` if and only if the specified `key` is in this version.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare>
+bool BasicPersistentAVLTree<Key, Value, Compare>::Snapshot::contains(const KeyType &key) const {
+	return this->findNode(key) != nullptr;
+}
+
+/**
+ *	Returns the value associated with the specified `key` in this version, or
+ *	nothing if the key is not in this version.
+ *
+ *	Expected time complexity is `O(log(n))`.
+ */
+template <typename Key, typename Value, typename Compare>
+std::optional<typename BasicPersistentAVLTree<Key, Value, Compare>::ValueType> BasicPersistentAVLTree<Key, Value, Compare>::Snapshot::get(const KeyType &key) const {
+	const Node *node = this->findNode(key);
+	if (!node) {
+		return std::nullopt;
+	}
+	return node->value;
+}
+
+/**
+ *	The snapshot owns its root, which owns every node below, so the descent
+ *	follows plain pointers without touching any reference count.
+ */
+template <typename Key, typename Value, typename Compare>
+const typename BasicPersistentAVLTree<Key, Value, Compare>::Node * BasicPersistentAVLTree<Key, Value, Compare>::Snapshot::findNode(const KeyType &key) const {
+	const Node *current = this->root.get();
+	while (current) {
+		int cmp = compareKeys(this->comp, key, current->key);
+		if (cmp < 0) {
+			current = current->left.get();
+		} else if (cmp > 0) {
+			current = current->right.get();
+		} else {
+			return current;
+		}
+	}
+	return nullptr;
+}
+
+/**
+ *	Returns a vector of every key in this version, in ascending order.
+ *
+ *	Expected time complexity is `O(n)`.
+ */
+template <typename Key, typename Value, typename Compare>
+std::vector<typename BasicPersistentAVLTree<Key, Value, Compare>::KeyType> BasicPersistentAVLTree<Key, Value, Compare>::Snapshot::keys() const {
+	std::vector<KeyType> keyList;
+	keyList.reserve(this->size());
+
+	std::vector<const Node *> stack;
+	const Node *current = this->root.get();
+	while (current || !stack.empty()) {
+		while (current) {
+			stack.push_back(current);
+			current = current->left.get();
+		}
+		current = stack.back();
+		stack.pop_back();
+		keyList.push_back(current->key);
+		current = current->right.get();
+	}
+	return keyList;
+}
+
+/**
+ *	Returns the values of the keys in `[low, high]` in this version, in
+ *	ascending order of the keys. Like `AVLTree::findRange`, a value that
+ *	occurs more than once is only returned the first time.
+ *
+ *	Expected time complexity is `O(log(n) + k)` for `k` pairs in the range.
+ */
+template <typename Key, typename Value, typename Compare>
+std::vector<typename BasicPersistentAVLTree<Key, Value, Compare>::ValueType> BasicPersistentAVLTree<Key, Value, Compare>::Snapshot::findRange(const KeyType &low, const KeyType &high) const {
+	std::vector<ValueType> valueList;
+	if constexpr (requires (const ValueType &value) {std::hash<ValueType>{}(value);}) {
+		std::unordered_set<ValueType> seen;
+		this->visitRange(low, high, [&](const KeyType &, const ValueType &value) {
+			if (seen.insert(value).second) {valueList.push_back(value);}
+		});
+	} else {
+		this->visitRange(low, high, [&](const KeyType &, const ValueType &value) {
+			valueList.push_back(value);
+		});
+	}
+	return valueList;
+}
+
+/**
+ *	Calls `visit(key, value)` for every pair of this version whose key lies in
+ *	`[low, high]`, in ascending order of the keys. Writers publishing newer
+ *	versions meanwhile neither wait for the scan nor change what it sees.
+ *
+ *	Expected time complexity is `O(log(n) + k)` for `k` pairs in the range.
+ */
+template <typename Key, typename Value, typename Compare>
+template <typename Visitor>
+void BasicPersistentAVLTree<Key, Value, Compare>::Snapshot::visitRange(const KeyType &low, const KeyType &high, Visitor &&visit) const {
+	this->visitRange(this->root.get(), low, high, visit);
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename Visitor>
+void BasicPersistentAVLTree<Key, Value, Compare>::Snapshot::visitRange(
+	const Node *current, const KeyType &low, const KeyType &high, Visitor &visit
+) const {
+	if (!current) {
+		return;
+	}
+
+	bool aboveLow = compareKeys(this->comp, low, current->key) <= 0;
+	bool belowHigh = compareKeys(this->comp, high, current->key) >= 0;
+
+	if (aboveLow) {
+		this->visitRange(current->left.get(), low, high, visit);
+	}
+	if (aboveLow && belowHigh) {
+		visit(current->key, current->value);
+	}
+	if (belowHigh) {
+		this->visitRange(current->right.get(), low, high, visit);
+	}
+}
+
+template <typename Key, typename Value, typename Compare>
+size_t BasicPersistentAVLTree<Key, Value, Compare>::Snapshot::size() const {
+	return countOf(this->root);
+}
+
+/**
+ *	Returns the number of edges from the root to its deepest leaf, like
+ *	`AVLTree::getHeight`, or `-1` cast to `size_t` if this version is empty.
+ */
+template <typename Key, typename Value, typename Compare>
+size_t BasicPersistentAVLTree<Key, Value, Compare>::Snapshot::getHeight() const {
+	return heightOf(this->root) - size_t{1};
+}
@@ -0,0 +1,11 @@
+/**
+ *	ShardedAVLTree.cpp
+ *
+ *	The method definitions of `BasicShardedAVLTree` live in
+ *	`ShardedAVLTree.tpp`. The default map, `ShardedAVLTree`, is instantiated
+ *	once here.
+ */
+
+#include "ShardedAVLTree.h"
+
+template class BasicShardedAVLTree<>;
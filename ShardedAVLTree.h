@@ -0,0 +1,131 @@
+/**
+ *	ShardedAVLTree.h
+ */
+
+#ifndef SHARDEDAVLTREE_H
+#define SHARDEDAVLTREE_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+#include "AVLTree.h"
+
+/**
+ *	A map split across several independent `BasicAVLTree` shards, so that
+ *	writers to different shards run in parallel. Each shard has its own lock
+ *	and its own node pool.
+ *
+ *	Keys are assigned to shards either by hashing them, which spreads any
+ *	workload evenly, or by ranges between split keys, which keeps each shard
+ *	a contiguous part of the key order.
+ *
+ *	Operations on one key lock one shard. Operations over many keys lock the
+ *	shards one after the other, so they are not a consistent view of the
+ *	whole map while other threads write to it.
+ *
+ *	`operator[]` returns a `Reference` rather than a reference to the value.
+ *	Reading it locks the shard once and gives a copy of the value, or a default
+ *	constructed value for a missing key, which is not inserted. Assigning to it
+ *	locks the shard again, so `map[key] = map[key] + 1` is two separate steps,
+ *	and an increment by another thread in between is lost. `update()` runs a
+ *	read-modify-write under one exclusive lock instead.
+ */
+template <
+	typename Key = std::string, typename Value = size_t,
+	typename Compare = std::less<>, typename Allocator = std::allocator<std::pair<const Key, Value>>
+>
+class BasicShardedAVLTree {
+	public:
+		using Tree = BasicAVLTree<Key, Value, Compare, Allocator>;
+		using KeyType = typename Tree::KeyType;
+		using ValueType = typename Tree::ValueType;
+
+		/** How keys are assigned to shards. */
+		enum class Partitioning {
+
+			/** By the hash of the key. */
+			HASH,
+
+			/** By the range between two consecutive split keys that the key falls in. */
+			RANGE,
+		};
+
+		/**
+		 *	The value of one key, as returned by `operator[]`. Reading or assigning
+		 *	it locks the shard of that key, so no reference to a value escapes its lock.
+		 *	It holds a copy of the key, so it may outlive the key it was made from.
+		 */
+		class Reference {
+			public:
+				operator ValueType() const;
+				Reference & operator=(ValueType value);
+
+			private:
+				friend class BasicShardedAVLTree;
+
+				BasicShardedAVLTree *map;
+				KeyType key;
+
+				Reference(BasicShardedAVLTree *map, const KeyType &key) : map(map), key(key) {}
+		};
+
+		explicit BasicShardedAVLTree(size_t shardCount, const Compare &comp = Compare());
+		explicit BasicShardedAVLTree(std::vector<KeyType> splitKeys, const Compare &comp = Compare());
+
+		BasicShardedAVLTree(const BasicShardedAVLTree &) = delete;
+		BasicShardedAVLTree & operator=(const BasicShardedAVLTree &) = delete;
+
+		bool insert(const KeyType &key, ValueType value);
+		bool remove(const KeyType &key);
+		bool contains(const KeyType &key) const;
+		std::optional<ValueType> get(const KeyType &key) const;
+		Reference operator[](const KeyType &key);
+
+		template <typename Fn>
+		bool update(const KeyType &key, Fn &&fn);
+
+		std::vector<KeyType> keys() const;
+		std::vector<ValueType> findRange(const KeyType &low, const KeyType &high) const;
+
+		size_t size() const;
+		size_t shardCount() const;
+		Partitioning partitioning() const;
+
+	private:
+
+		/** Padded to a cache line, so that the locks of neighbouring shards don't share one. */
+		struct alignas(64) Shard {
+			mutable std::shared_mutex mutex;
+			Tree tree;
+
+			explicit Shard(const Compare &comp) : tree(comp) {}
+		};
+
+		std::vector<std::unique_ptr<Shard>> shards;
+		Partitioning mode;
+
+		/** For range partitioning, shard `i` holds the keys in `[splitKeys[i - 1], splitKeys[i])`. */
+		std::vector<KeyType> splitKeys;
+
+		Compare comp;
+
+		size_t shardOf(const KeyType &key) const;
+		Shard & shardFor(const KeyType &key);
+		const Shard & shardFor(const KeyType &key) const;
+
+		template <typename Emit>
+		void mergeShards(const KeyType *low, const KeyType *high, Emit &&emit) const;
+};
+
+#include "ShardedAVLTree.tpp"
+
+/** The sharded map of `std::string` keys and `size_t` values, which is instantiated once in `ShardedAVLTree.cpp`. */
+using ShardedAVLTree = BasicShardedAVLTree<>;
+
+extern template class BasicShardedAVLTree<>;
+
+#endif // SHARDEDAVLTREE_H
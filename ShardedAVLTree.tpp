@@ -0,0 +1,256 @@
+/**
+ *	ShardedAVLTree.tpp
+ *
+ *	Contains all method definitions of the class template declared in
+ *	`ShardedAVLTree.h`, which includes this file.
+ */
+
+#include <algorithm>
+#include <mutex>
+#include <queue>
+#include <unordered_set>
+#include <utility>
+
+/** Create a map of `shardCount` shards, which keys are assigned to by their hashes. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+BasicShardedAVLTree<Key, Value, Compare, Allocator>::BasicShardedAVLTree(size_t shardCount, const Compare &comp) :
+	mode(Partitioning::HASH), comp(comp) {
+	for (size_t i = 0; i < std::max<size_t>(shardCount, 1); ++i) {
+		this->shards.push_back(std::make_unique<Shard>(comp));
+	}
+}
+
+/**
+ *	Create a map partitioned by ranges, with one more shard than there are
+ *	distinct `splitKeys`. The keys smaller than every split key go to the first
+ *	shard, and each split key starts a new shard.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+BasicShardedAVLTree<Key, Value, Compare, Allocator>::BasicShardedAVLTree(std::vector<KeyType> splitKeys, const Compare &comp) :
+	mode(Partitioning::RANGE), splitKeys(std::move(splitKeys)), comp(comp) {
+	std::sort(this->splitKeys.begin(), this->splitKeys.end(), this->comp);
+	this->splitKeys.erase(std::unique(this->splitKeys.begin(), this->splitKeys.end(), [this](const KeyType &a, const KeyType &b) {
+		return !this->comp(a, b) && !this->comp(b, a);
+	}), this->splitKeys.end());
+
+	for (size_t i = 0; i <= this->splitKeys.size(); ++i) {
+		this->shards.push_back(std::make_unique<Shard>(comp));
+	}
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicShardedAVLTree<Key, Value, Compare, Allocator>::shardOf(const KeyType &key) const {
+	if (this->mode == Partitioning::RANGE) {
+		return std::upper_bound(this->splitKeys.begin(), this->splitKeys.end(), key, this->comp) - this->splitKeys.begin();
+	}
+
+	/** The hash is mixed first, since `std::hash` may be the identity for integers. */
+	size_t hash = std::hash<KeyType>{}(key);
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	return hash % this->shards.size();
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicShardedAVLTree<Key, Value, Compare, Allocator>::Shard & BasicShardedAVLTree<Key, Value, Compare, Allocator>::shardFor(const KeyType &key) {
+	return *this->shards[this->shardOf(key)];
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+const typename BasicShardedAVLTree<Key, Value, Compare, Allocator>::Shard & BasicShardedAVLTree<Key, Value, Compare, Allocator>::shardFor(const KeyType &key) const {
+	return *this->shards[this->shardOf(key)];
+}
+
+/**
+ *	Inserts the key-value pair into the shard of the key, while only that shard is locked.
+ *	Same as `AVLTree::insert`, an existing key has its value updated.
+ *
+ *	Expected time complexity is `O(log(n / shards))`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicShardedAVLTree<Key, Value, Compare, Allocator>::insert(const KeyType &key, ValueType value) {
+	Shard &shard = this->shardFor(key);
+	std::unique_lock lock(shard.mutex);
+	return shard.tree.insert(key, std::move(value));
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicShardedAVLTree<Key, Value, Compare, Allocator>::remove(const KeyType &key) {
+	Shard &shard = this->shardFor(key);
+	std::unique_lock lock(shard.mutex);
+	return shard.tree.remove(key);
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+bool BasicShardedAVLTree<Key, Value, Compare, Allocator>::contains(const KeyType &key) const {
+	const Shard &shard = this->shardFor(key);
+	std::shared_lock lock(shard.mutex);
+	return shard.tree.contains(key);
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+std::optional<typename BasicShardedAVLTree<Key, Value, Compare, Allocator>::ValueType> BasicShardedAVLTree<Key, Value, Compare, Allocator>::get(const KeyType &key) const {
+	const Shard &shard = this->shardFor(key);
+	std::shared_lock lock(shard.mutex);
+	return shard.tree.get(key);
+}
+
+/**
+ *	Returns the value of `key`, which can be read or assigned to.
+ *	Reading a key that doesn't exist gives a default constructed value without
+ *	inserting the key, and assigning to it inserts the key. Use `update()` to
+ *	change a value based on itself.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicShardedAVLTree<Key, Value, Compare, Allocator>::Reference BasicShardedAVLTree<Key, Value, Compare, Allocator>::operator[](const KeyType &key) {
+	return Reference(this, key);
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+BasicShardedAVLTree<Key, Value, Compare, Allocator>::Reference::operator ValueType() const {
+	return this->map->get(this->key).value_or(ValueType{});
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicShardedAVLTree<Key, Value, Compare, Allocator>::Reference & BasicShardedAVLTree<Key, Value, Compare, Allocator>::Reference::operator=(ValueType value) {
+	this->map->insert(this->key, std::move(value));
+	return *this;
+}
+
+/**
+ *	Calls `fn(value)` with a reference to the value of `key`, while the shard
+ *	of the key is locked exclusively, so that no other thread reads or writes
+ *	the value in between. A missing key is inserted with a default constructed
+ *	value first.
+ *
+ *	@return `true` if the key was inserted, or `false` if it already existed.
+ *
+ *	Expected time complexity is `O(log(n / shards))`, plus the time of `fn`.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename Fn>
+bool BasicShardedAVLTree<Key, Value, Compare, Allocator>::update(const KeyType &key, Fn &&fn) {
+	Shard &shard = this->shardFor(key);
+	std::unique_lock lock(shard.mutex);
+	auto [it, inserted] = shard.tree.try_emplace(key);
+	std::forward<Fn>(fn)(it->value);
+	return inserted;
+}
+
+/**
+ *	Returns a vector of every key in the map, in ascending order.
+ *
+ *	Expected time complexity is `O(n)` for range partitioning, or
+ *	`O(n log(shards))` for hash partitioning.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+std::vector<typename BasicShardedAVLTree<Key, Value, Compare, Allocator>::KeyType> BasicShardedAVLTree<Key, Value, Compare, Allocator>::keys() const {
+	std::vector<KeyType> keyList;
+	keyList.reserve(this->size());
+	this->mergeShards(nullptr, nullptr, [&](const KeyType &key, const ValueType &) {
+		keyList.push_back(key);
+	});
+	return keyList;
+}
+
+/**
+ *	Returns the values of the keys in `[low, high]`, in ascending order of the
+ *	keys. Like `AVLTree::findRange`, a value that occurs more than once is
+ *	only returned the first time, unless values have no `std::hash`.
+ *
+ *	With range partitioning, only the shards overlapping the range are visited.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+std::vector<typename BasicShardedAVLTree<Key, Value, Compare, Allocator>::ValueType> BasicShardedAVLTree<Key, Value, Compare, Allocator>::findRange(const KeyType &low, const KeyType &high) const {
+	std::vector<ValueType> valueList;
+	if constexpr (requires (const ValueType &value) {std::hash<ValueType>{}(value);}) {
+		std::unordered_set<ValueType> seen;
+		this->mergeShards(&low, &high, [&](const KeyType &, const ValueType &value) {
+			if (seen.insert(value).second) {valueList.push_back(value);}
+		});
+	} else {
+		this->mergeShards(&low, &high, [&](const KeyType &, const ValueType &value) {
+			valueList.push_back(value);
+		});
+	}
+	return valueList;
+}
+
+/**
+ *	Calls `emit(key, value)` for every pair in `[*low, *high]`, or in the whole
+ *	map if the bounds are `nullptr`, in ascending order of the keys.
+ *
+ *	Range partitions are already ordered, so their pairs are emitted shard by
+ *	shard, straight from each shard while its shared lock is held. Hash
+ *	partitions interleave, so each of them is copied out under its own shared
+ *	lock, and their sorted runs are k-way merged through a heap.
+ */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+template <typename Emit>
+void BasicShardedAVLTree<Key, Value, Compare, Allocator>::mergeShards(const KeyType *low, const KeyType *high, Emit &&emit) const {
+	using Pair = std::pair<KeyType, ValueType>;
+
+	auto visitShard = [&](const Shard &shard, auto &&visit) {
+		std::shared_lock lock(shard.mutex);
+		if (low) {
+			shard.tree.visitRange(*low, *high, visit);
+		} else {
+			for (const typename Tree::Entry &entry : shard.tree) {visit(entry.key, entry.value);}
+		}
+	};
+
+	if (this->mode == Partitioning::RANGE) {
+		size_t first = low ? this->shardOf(*low) : 0;
+		size_t last = high ? this->shardOf(*high) : this->shards.size() - 1;
+		for (size_t i = first; i <= last && i < this->shards.size(); ++i) {
+			visitShard(*this->shards[i], emit);
+		}
+		return;
+	}
+
+	std::vector<std::vector<Pair>> runs(this->shards.size());
+	for (size_t i = 0; i < this->shards.size(); ++i) {
+		visitShard(*this->shards[i], [&](const KeyType &key, const ValueType &value) {
+			runs[i].emplace_back(key, value);
+		});
+	}
+
+	/** Each heap entry is a run and the position of its next pair, with the smallest key on top. */
+	using Cursor = std::pair<size_t, size_t>;
+	auto greater = [&](const Cursor &a, const Cursor &b) {
+		return this->comp(runs[b.first][b.second].first, runs[a.first][a.second].first);
+	};
+	std::priority_queue<Cursor, std::vector<Cursor>, decltype(greater)> heap(greater);
+	for (size_t i = 0; i < runs.size(); ++i) {
+		if (!runs[i].empty()) {heap.push({i, 0});}
+	}
+
+	while (!heap.empty()) {
+		auto [run, position] = heap.top();
+		heap.pop();
+		emit(runs[run][position].first, runs[run][position].second);
+		if (position + 1 < runs[run].size()) {heap.push({run, position + 1});}
+	}
+}
+
+/** Returns the number of pairs in all shards together. */
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicShardedAVLTree<Key, Value, Compare, Allocator>::size() const {
+	size_t total = 0;
+	for (const std::unique_ptr<Shard> &shard : this->shards) {
+		std::shared_lock lock(shard->mutex);
+		total += shard->tree.size();
+	}
+	return total;
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+size_t BasicShardedAVLTree<Key, Value, Compare, Allocator>::shardCount() const {
+	return this->shards.size();
+}
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+typename BasicShardedAVLTree<Key, Value, Compare, Allocator>::Partitioning BasicShardedAVLTree<Key, Value, Compare, Allocator>::partitioning() const {
+	return this->mode;
+}
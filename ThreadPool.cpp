@@ -0,0 +1,140 @@
+/**
+ *	ThreadPool.cpp
+ */
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace {
+
+	/** The pool whose worker is running on this thread, and the index of that worker. */
+	thread_local const ThreadPool *currentPool = nullptr;
+	thread_local size_t currentWorker = 0;
+}
+
+/** Starts `threadCount` workers. A pool without workers runs every forked call on the calling thread. */
+ThreadPool::ThreadPool(size_t threadCount) : workerCount(threadCount), pending(0), stopping(false) {
+	for (size_t i = 0; i <= threadCount; ++i) {
+		this->queues.push_back(std::make_unique<Queue>());
+	}
+	this->workers.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i) {
+		this->workers.emplace_back(&ThreadPool::work, this, i);
+	}
+}
+
+/** Stops the workers. No call to `invoke()` may still be running. */
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard lock(this->sleepMutex);
+		this->stopping = true;
+	}
+	this->wake.notify_all();
+	for (std::thread &worker : this->workers) {worker.join();}
+}
+
+/** Returns the number of worker threads. */
+size_t ThreadPool::size() const {return this->workerCount;}
+
+/** The queue of the calling thread if it is a worker of this pool, or else the shared queue. */
+size_t ThreadPool::queueOfCaller() const {
+	return (currentPool == this) ? currentWorker : this->workerCount;
+}
+
+void ThreadPool::push(size_t queue, Task *task) {
+	{
+		std::lock_guard lock(this->queues[queue]->mutex);
+		this->queues[queue]->tasks.push_back(task);
+	}
+	this->pending.fetch_add(1, std::memory_order_release);
+
+	/** Taking the lock orders this push before a worker that is about to sleep checks `pending`. */
+	{
+		std::lock_guard lock(this->sleepMutex);
+	}
+	this->wake.notify_one();
+}
+
+/**
+ *	Removes the `task` from the `queue` if no thread took it yet.
+ *	Every task forked after it has been finished by now, so it is usually at the back.
+ */
+bool ThreadPool::takeBack(size_t queue, Task *task) {
+	std::lock_guard lock(this->queues[queue]->mutex);
+	std::deque<Task *> &tasks = this->queues[queue]->tasks;
+	auto it = std::find(tasks.rbegin(), tasks.rend(), task);
+	if (it == tasks.rend()) {
+		return false;
+	}
+
+	tasks.erase(std::next(it).base());
+	this->pending.fetch_sub(1, std::memory_order_relaxed);
+	return true;
+}
+
+/** Runs other tasks, starting with the `queue`, until another thread has finished the `task`. */
+void ThreadPool::waitFor(size_t queue, const Task &task) {
+	while (!task.done.load(std::memory_order_acquire)) {
+		if (!this->runOne(queue)) {std::this_thread::yield();}
+	}
+}
+
+/**
+ *	Runs one task, which is the newest task of the caller's own `queue`, or
+ *	else the oldest task of another queue.
+ *
+ *	@return `false` if every queue was empty.
+ */
+bool ThreadPool::runOne(size_t queue) {
+	Task *task = nullptr;
+	if (queue < this->workerCount) {
+		std::lock_guard lock(this->queues[queue]->mutex);
+		if (!this->queues[queue]->tasks.empty()) {
+			task = this->queues[queue]->tasks.back();
+			this->queues[queue]->tasks.pop_back();
+		}
+	}
+
+	for (size_t i = 1; !task && i <= this->queues.size(); ++i) {
+		Queue &victim = *this->queues[(queue + i) % this->queues.size()];
+		std::lock_guard lock(victim.mutex);
+		if (!victim.tasks.empty()) {
+			task = victim.tasks.front();
+			victim.tasks.pop_front();
+		}
+	}
+
+	if (!task) {
+		return false;
+	}
+
+	this->pending.fetch_sub(1, std::memory_order_relaxed);
+	try {
+		task->run(task->fn);
+	} catch (...) {
+		task->error = std::current_exception();
+	}
+	task->done.store(true, std::memory_order_release);
+	return true;
+}
+
+/** The loop of a worker thread, which sleeps while no task is waiting. */
+void ThreadPool::work(size_t index) {
+	currentPool = this;
+	currentWorker = index;
+
+	while (true) {
+		if (this->runOne(index)) {
+			continue;
+		}
+
+		std::unique_lock lock(this->sleepMutex);
+		this->wake.wait(lock, [this] {
+			return this->stopping || this->pending.load(std::memory_order_acquire) > 0;
+		});
+		if (this->stopping) {
+			return;
+		}
+	}
+}
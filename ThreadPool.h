@@ -0,0 +1,127 @@
+/**
+ *	ThreadPool.h
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ *	A fixed set of worker threads that run fork-join work.
+ *
+ *	Every worker has its own deque of forked tasks. A worker pushes and pops
+ *	its own tasks at the back, so it keeps working on the most recent task,
+ *	whose data is still in its cache. An idle worker steals from the front of
+ *	another deque, where the oldest and usually largest piece of work is.
+ *
+ *	A thread that waits for a forked task to finish runs other tasks in the
+ *	meantime instead of blocking, so nested forks can't deadlock. Threads that
+ *	are not workers of the pool can fork as well, and their tasks go to a
+ *	shared deque that every worker steals from.
+ */
+class ThreadPool {
+	public:
+		explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool &) = delete;
+		ThreadPool & operator=(const ThreadPool &) = delete;
+
+		template <typename Left, typename Right>
+		void invoke(Left &&left, Right &&right);
+
+		size_t size() const;
+
+	private:
+
+		/**
+		 *	A forked call, which lives on the stack of the thread that forked it.
+		 *	An exception thrown by the call is kept in `error`, for the forking
+		 *	thread to rethrow.
+		 */
+		struct Task {
+			void (*run)(void *fn);
+			void *fn;
+			std::atomic<bool> done;
+			std::exception_ptr error;
+		};
+
+		struct Queue {
+			std::mutex mutex;
+			std::deque<Task *> tasks;
+		};
+
+		/** Fixed before any worker starts, since the workers read it while the others are still starting. */
+		const size_t workerCount;
+
+		/** One queue per worker, followed by the queue shared by other threads. */
+		std::vector<std::unique_ptr<Queue>> queues;
+		std::vector<std::thread> workers;
+
+		/** Number of tasks waiting in any of the queues. */
+		std::atomic<size_t> pending;
+		std::atomic<bool> stopping;
+
+		std::mutex sleepMutex;
+		std::condition_variable wake;
+
+		template <typename Fn>
+		static void call(void *fn) {(*static_cast<Fn *>(fn))();}
+
+		size_t queueOfCaller() const;
+		void push(size_t queue, Task *task);
+		bool takeBack(size_t queue, Task *task);
+		void waitFor(size_t queue, const Task &task);
+		bool runOne(size_t queue);
+		void work(size_t index);
+};
+
+/**
+ *	Calls `left()` and `right()`, possibly at the same time on two threads,
+ *	and returns once both have returned.
+ *
+ *	The calling thread forks `right()` into its queue and runs `left()` itself.
+ *	If no other thread took `right()` by then, the calling thread runs it too.
+ *
+ *	An exception thrown by either call is rethrown here, once `right()` has
+ *	either been taken back or has finished on another thread, since its task
+ *	lives on this stack. If both throw, the exception of `left()` is rethrown.
+ */
+template <typename Left, typename Right>
+void ThreadPool::invoke(Left &&left, Right &&right) {
+	if (this->workerCount == 0) {
+		left();
+		right();
+		return;
+	}
+
+	auto forked = [&right] {right();};
+	Task task{&ThreadPool::call<decltype(forked)>, &forked, false, nullptr};
+	size_t queue = this->queueOfCaller();
+	this->push(queue, &task);
+
+	try {
+		left();
+	} catch (...) {
+		if (!this->takeBack(queue, &task)) {this->waitFor(queue, task);}
+		throw;
+	}
+
+	if (this->takeBack(queue, &task)) {
+		right();
+		return;
+	}
+	this->waitFor(queue, task);
+	if (task.error) {std::rethrow_exception(task.error);}
+}
+
+#endif // THREADPOOL_H